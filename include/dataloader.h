@@ -0,0 +1,54 @@
+#ifndef SMOL_TORCH_DATALOADER_H
+#define SMOL_TORCH_DATALOADER_H
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "tensor.h"
+
+typedef enum {
+    LOADER_BINARY,
+    LOADER_CSV
+} LoaderFormat;
+
+// One field of a record: `count` consecutive values of `dtype`. Every
+// column becomes one batch tensor of shape (batch,) or (batch, count).
+typedef struct {
+    Dtype dtype;
+    int64_t count;
+} LoaderColumn;
+
+typedef struct {
+    LoaderFormat format;
+    int64_t batch_size;
+    int32_t prefetch;      // batches decoded ahead of the consumer
+    int32_t num_workers;   // background decoding threads
+    uint64_t seed;
+    bool shuffle;
+    bool drop_last;
+    bool csv_header;       // skip the first line of a CSV file
+} DataLoaderOptions;
+
+typedef struct DataLoader DataLoader;
+
+// Binary files are fixed-size records with the columns packed back to back
+// in native byte order and are memory-mapped. CSV files are read in one
+// sequential pass and decoded into the same packed layout up front.
+// A loader is driven by one thread at a time: calls on the same loader must
+// not overlap (the prefetch workers are internal and need no care).
+DataLoader* dataloader_open(const char* path, const LoaderColumn* columns, int32_t num_columns,
+                            const DataLoaderOptions* options);
+void dataloader_free(DataLoader* loader);
+
+int64_t dataloader_num_records(const DataLoader* loader);
+int64_t dataloader_num_batches(const DataLoader* loader);
+
+// Starts (or restarts) an epoch: reshuffles with seed + epoch and launches
+// the prefetch workers. Returns 0 on success, -1 on failure.
+int dataloader_start_epoch(DataLoader* loader);
+
+// Blocks until the next batch is decoded and hands its tensors to the
+// caller, one per column. Starts the first epoch if none has been started.
+// Returns 1 for a batch, 0 at the end of the epoch and -1 on error.
+int dataloader_next(DataLoader* loader, Tensor** out);
+
+#endif //SMOL_TORCH_DATALOADER_H
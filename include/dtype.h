@@ -1,5 +1,7 @@
 #ifndef SMOL_TORCH_DTYPE_H
 #define SMOL_TORCH_DTYPE_H
+#include <stdbool.h>
+#include <stdint.h>
 
 typedef enum {
     DTYPE_INT32,
@@ -13,5 +15,9 @@ int get_tensor_dtype_size(Dtype dtype);
 
 Dtype promote(Dtype a, Dtype b);
 const char* dtype_name(Dtype dtype);
+void dtype_cast(void* dst, Dtype to, const void* src, Dtype from, int64_t n);
+// Returns src when it already has dtype to, otherwise a converted copy the
+// caller has to free (signalled through *owned).
+const void* dtype_as(const void* src, Dtype from, Dtype to, int64_t n, bool* owned);
 
 #endif // SMOL_TORCH_DTYPE_H
@@ -0,0 +1,39 @@
+#ifndef SMOL_TORCH_INDEXING_H
+#define SMOL_TORCH_INDEXING_H
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "tensor.h"
+
+typedef enum {
+    EMBEDDING_BAG_SUM,
+    EMBEDDING_BAG_MEAN
+} EmbeddingBagMode;
+
+// Elements start, start + step, ... (length of them) along one dimension.
+// A squeezed range has length 1 and drops its dimension from the result.
+typedef struct {
+    int64_t start;
+    int64_t step;
+    int64_t length;
+    bool squeeze;
+} TensorRange;
+
+// Index tensors are int32 or int64. Masks are int32 or int64 tensors of
+// the same shape as the input, where any non-zero element selects.
+Tensor* index_select_tensor(const Tensor* a, int32_t dim, const Tensor* index);
+Tensor* gather_tensor(const Tensor* a, int32_t dim, const Tensor* index);
+Tensor* scatter_add_tensor(const Tensor* a, int32_t dim, const Tensor* index, const Tensor* src);
+Tensor* masked_select_tensor(const Tensor* a, const Tensor* mask);
+Tensor* embedding_bag_tensor(const Tensor* weight, const Tensor* indices, const Tensor* offsets,
+                             EmbeddingBagMode mode);
+
+// Copies out the region described by one range per dimension of a.
+Tensor* slice_tensor(const Tensor* a, const TensorRange* ranges);
+
+// In-place kernels; return 0 on success and -1 on invalid arguments.
+int t_scatter_add(Tensor* a, int32_t dim, const Tensor* index, const Tensor* src);
+int t_index_copy(Tensor* a, int32_t dim, const Tensor* index, const Tensor* src);
+int t_assign_slice(Tensor* a, const TensorRange* ranges, const Tensor* src);
+
+#endif //SMOL_TORCH_INDEXING_H
@@ -0,0 +1,41 @@
+#ifndef SMOL_TORCH_OPTIM_H
+#define SMOL_TORCH_OPTIM_H
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "tensor.h"
+
+typedef struct {
+    double lr;
+    double momentum;
+    double dampening;
+    double weight_decay;
+    bool nesterov;
+} SgdOptions;
+
+typedef struct {
+    double lr;
+    double beta1;
+    double beta2;
+    double eps;
+    double weight_decay;
+    bool decoupled_weight_decay;   // AdamW
+} AdamOptions;
+
+// Fused multi-tensor steps. Every parameter is updated together with its
+// optimizer state in one read-modify-write pass, split into fixed-size
+// chunks that are spread over threads regardless of which tensor they
+// belong to.
+//
+// params and grads are float32 or float64 of matching dtype and shape.
+// masters is NULL or holds, per parameter, NULL or a float64 master copy
+// of a float32 parameter; the update then runs on the master and is
+// rounded back into the parameter. State tensors use the master's dtype
+// when there is one and the parameter's otherwise. step counts from 1.
+// Returns 0 on success and -1, without touching anything, on bad input.
+int sgd_step(Tensor** params, Tensor** grads, Tensor** momentum_buffers, Tensor** masters,
+             int32_t n, int64_t step, const SgdOptions* options);
+int adam_step(Tensor** params, Tensor** grads, Tensor** exp_avgs, Tensor** exp_avg_sqs, Tensor** masters,
+              int32_t n, int64_t step, const AdamOptions* options);
+
+#endif //SMOL_TORCH_OPTIM_H
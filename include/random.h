@@ -0,0 +1,24 @@
+#ifndef SMOL_TORCH_RANDOM_H
+#define SMOL_TORCH_RANDOM_H
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "tensor.h"
+
+// Philox4x32-10 counter-based generator. Every fill draws a fresh range of
+// counters from the global (seed, offset) state, so element i of a tensor
+// always comes from the same counter no matter how many threads run.
+void manual_seed(uint64_t seed);
+uint64_t initial_seed(void);
+
+void t_uniform(Tensor* out, double low, double high);
+void t_normal(Tensor* out, double mean, double std);
+void t_randint(Tensor* out, int64_t low, int64_t high);
+
+Tensor* rand_tensor(int64_t* shape, int32_t ndim, Dtype dtype);
+Tensor* randn_tensor(int64_t* shape, int32_t ndim, Dtype dtype);
+Tensor* randint_tensor(int64_t low, int64_t high, int64_t* shape, int32_t ndim, Dtype dtype);
+Tensor* bernoulli_tensor(const Tensor* p);
+Tensor* dropout_tensor(const Tensor* a, double p, bool training);
+
+#endif //SMOL_TORCH_RANDOM_H
@@ -0,0 +1,46 @@
+#ifndef SMOL_TORCH_SPARSE_H
+#define SMOL_TORCH_SPARSE_H
+#include <stdint.h>
+
+#include "tensor.h"
+
+typedef enum {
+    SPARSE_COO,
+    SPARSE_CSR
+} SparseLayout;
+
+// A 2-D sparse matrix. Entries are always sorted row-major and coalesced,
+// so COO and CSR only differ in how the rows are stored: COO keeps one row
+// index per entry, CSR keeps shape[0] + 1 row pointers.
+typedef struct {
+    void* values;
+    int64_t* row_indices;   // COO only, nnz entries
+    int64_t* row_ptr;       // CSR only, shape[0] + 1 entries
+    int64_t* col_indices;   // nnz entries
+    int64_t shape[2];
+    int64_t nnz;
+    SparseLayout layout;
+    Dtype dtype;
+    Device device;
+} SparseTensor;
+
+SparseTensor* create_sparse_coo(const int64_t* rows, const int64_t* cols, const void* values,
+                                int64_t nnz, const int64_t* shape, Dtype dtype);
+void sparse_free(SparseTensor* s);
+
+SparseTensor* sparse_from_dense(const Tensor* t, SparseLayout layout);
+Tensor* sparse_to_dense(const SparseTensor* s);
+SparseTensor* sparse_to_csr(const SparseTensor* s);
+SparseTensor* sparse_to_coo(const SparseTensor* s);
+
+// b is 1-D (SpMV, returns shape[0]) or 2-D (SpMM, returns shape[0] x b->shape[1]).
+Tensor* sparse_matmul(const SparseTensor* a, const Tensor* b);
+
+// Elementwise ops: add keeps the union of both patterns, mul the
+// intersection. Identical patterns only touch the values.
+SparseTensor* sparse_add(const SparseTensor* a, const SparseTensor* b);
+SparseTensor* sparse_mul(const SparseTensor* a, const SparseTensor* b);
+
+char* sparse_to_string(const SparseTensor* s);
+
+#endif //SMOL_TORCH_SPARSE_H
@@ -24,6 +24,9 @@ typedef struct {
 } Tensor;
 
 Tensor* create_tensor(int64_t* shape, int ndim, Dtype dtype);
+// Like create_tensor, but the data is left uninitialised for callers that
+// overwrite every element.
+Tensor* create_tensor_empty(int64_t* shape, int ndim, Dtype dtype);
 Tensor* create_tensor_with_data(const void* data, int64_t* shape, int ndim, Dtype dtype);
 void tensor_free(Tensor* tensor);
 
@@ -0,0 +1,310 @@
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dataloader.h"
+#include "python_dataloader.h"
+#include "python_tensor.h"
+
+static void PyDataLoader_dealloc(PyDataLoaderObject* self) {
+    if (self->loader) {
+        Py_BEGIN_ALLOW_THREADS
+        dataloader_free(self->loader);
+        Py_END_ALLOW_THREADS
+    }
+    free(self->batch);
+    Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+static PyObject* PyDataLoader_new(PyTypeObject* type, PyObject* args, PyObject* kwds) {
+    PyDataLoaderObject* self = (PyDataLoaderObject*)type->tp_alloc(type, 0);
+    if (self) {
+        self->loader = NULL;
+        self->batch = NULL;
+        self->num_columns = 0;
+        self->busy = false;
+    }
+    return (PyObject*)self;
+}
+
+// The C loader is not safe for overlapping calls, and its calls release the
+// GIL, so a second thread reaching the same loader is turned away here while
+// the GIL is still held.
+static int claim_loader(PyDataLoaderObject* self) {
+    if (self->busy) {
+        PyErr_SetString(PyExc_RuntimeError, "DataLoader is already in use by another thread");
+        return -1;
+    }
+    self->busy = true;
+    return 0;
+}
+
+static LoaderColumn* parse_columns(PyObject* columns_list, int32_t* num_columns) {
+    if (!PyList_Check(columns_list) || PyList_Size(columns_list) == 0) {
+        PyErr_SetString(PyExc_TypeError, "columns must be a non-empty list of (dtype, count) tuples");
+        return NULL;
+    }
+
+    const Py_ssize_t n = PyList_Size(columns_list);
+    if (n > INT32_MAX) {
+        PyErr_SetString(PyExc_ValueError, "Too many columns");
+        return NULL;
+    }
+
+    LoaderColumn* columns = malloc(sizeof(LoaderColumn) * n);
+    if (!columns) {
+        PyErr_SetString(PyExc_RuntimeError, "Memory allocation failed");
+        return NULL;
+    }
+
+    for (Py_ssize_t i = 0; i < n; i++) {
+        PyObject* item = PyList_GetItem(columns_list, i);
+        const char* dtype_str;
+        long long count;
+        if (!PyTuple_Check(item) || !PyArg_ParseTuple(item, "sL", &dtype_str, &count)) {
+            free(columns);
+            PyErr_SetString(PyExc_TypeError, "columns must be a non-empty list of (dtype, count) tuples");
+            return NULL;
+        }
+        if (PyTensor_parse_dtype(dtype_str, &columns[i].dtype) < 0) {
+            free(columns);
+            return NULL;
+        }
+        if (count <= 0) {
+            free(columns);
+            PyErr_SetString(PyExc_ValueError, "Column counts must be positive");
+            return NULL;
+        }
+        columns[i].count = count;
+    }
+
+    *num_columns = (int32_t)n;
+    return columns;
+}
+
+static int PyDataLoader_init(PyDataLoaderObject* self, PyObject* args, PyObject* kwds) {
+    PyObject* path_obj;
+    PyObject* columns_list;
+    long long batch_size = 1;
+    int shuffle = 0;
+    unsigned long long seed = 0;
+    int prefetch = 2;
+    int num_workers = 1;
+    int drop_last = 0;
+    const char* format_str = "binary";
+    int header = 0;
+
+    static char* keywords[] = {"path", "columns", "batch_size", "shuffle", "seed", "prefetch",
+                               "num_workers", "drop_last", "format", "header", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O&O|LpKiipsp", keywords, PyUnicode_FSConverter, &path_obj,
+                                     &columns_list, &batch_size, &shuffle, &seed, &prefetch,
+                                     &num_workers, &drop_last, &format_str, &header)) {
+        return -1;
+    }
+
+    DataLoaderOptions options = {
+        .batch_size = batch_size,
+        .prefetch = prefetch,
+        .num_workers = num_workers,
+        .seed = seed,
+        .shuffle = shuffle,
+        .drop_last = drop_last,
+        .csv_header = header,
+    };
+    if (strcmp(format_str, "binary") == 0) {
+        options.format = LOADER_BINARY;
+    } else if (strcmp(format_str, "csv") == 0) {
+        options.format = LOADER_CSV;
+    } else {
+        Py_DECREF(path_obj);
+        PyErr_SetString(PyExc_ValueError, "Unsupported format, expected 'binary' or 'csv'");
+        return -1;
+    }
+    if (batch_size <= 0 || prefetch <= 0 || num_workers <= 0) {
+        Py_DECREF(path_obj);
+        PyErr_SetString(PyExc_ValueError, "batch_size, prefetch and num_workers must be positive");
+        return -1;
+    }
+
+    int32_t num_columns;
+    LoaderColumn* columns = parse_columns(columns_list, &num_columns);
+    if (!columns) {
+        Py_DECREF(path_obj);
+        return -1;
+    }
+
+    Tensor** batch = calloc(num_columns, sizeof(Tensor*));
+    if (!batch) {
+        Py_DECREF(path_obj);
+        free(columns);
+        PyErr_SetString(PyExc_RuntimeError, "Memory allocation failed");
+        return -1;
+    }
+
+    const char* path = PyBytes_AsString(path_obj);
+    DataLoader* loader;
+    Py_BEGIN_ALLOW_THREADS
+    loader = dataloader_open(path, columns, num_columns, &options);
+    Py_END_ALLOW_THREADS
+    free(columns);
+
+    if (!loader) {
+        PyErr_Format(PyExc_RuntimeError, "Failed to open data loader for %s", path);
+        Py_DECREF(path_obj);
+        free(batch);
+        return -1;
+    }
+    Py_DECREF(path_obj);
+
+    if (self->busy) {
+        dataloader_free(loader);
+        free(batch);
+        PyErr_SetString(PyExc_RuntimeError, "DataLoader is already in use by another thread");
+        return -1;
+    }
+    if (self->loader) {
+        dataloader_free(self->loader);
+    }
+    free(self->batch);
+    self->loader = loader;
+    self->batch = batch;
+    self->num_columns = num_columns;
+    return 0;
+}
+
+static PyObject* PyDataLoader_iter(PyDataLoaderObject* self) {
+    if (!self->loader) {
+        PyErr_SetString(PyExc_RuntimeError, "DataLoader is not initialized");
+        return NULL;
+    }
+
+    if (claim_loader(self) < 0) {
+        return NULL;
+    }
+    int status;
+    Py_BEGIN_ALLOW_THREADS
+    status = dataloader_start_epoch(self->loader);
+    Py_END_ALLOW_THREADS
+    self->busy = false;
+    if (status < 0) {
+        PyErr_SetString(PyExc_RuntimeError, "Failed to start data loader epoch");
+        return NULL;
+    }
+
+    Py_INCREF(self);
+    return (PyObject*)self;
+}
+
+static PyObject* PyDataLoader_iternext(PyDataLoaderObject* self) {
+    if (!self->loader) {
+        PyErr_SetString(PyExc_RuntimeError, "DataLoader is not initialized");
+        return NULL;
+    }
+
+    if (claim_loader(self) < 0) {
+        return NULL;
+    }
+    // Only tensors handed over by this call may be freed on failure.
+    memset(self->batch, 0, sizeof(Tensor*) * self->num_columns);
+    int status;
+    Py_BEGIN_ALLOW_THREADS
+    status = dataloader_next(self->loader, self->batch);
+    Py_END_ALLOW_THREADS
+    self->busy = false;
+
+    if (status == 0) {
+        return NULL;  // StopIteration
+    }
+    if (status < 0) {
+        for (int32_t c = 0; c < self->num_columns; c++) tensor_free(self->batch[c]);
+        PyErr_SetString(PyExc_RuntimeError, "Failed to load batch");
+        return NULL;
+    }
+
+    PyObject* out = PyTuple_New(self->num_columns);
+    if (!out) {
+        for (int32_t c = 0; c < self->num_columns; c++) tensor_free(self->batch[c]);
+        return NULL;
+    }
+    for (int32_t c = 0; c < self->num_columns; c++) {
+        PyObject* t = PyTensor_wrap(self->batch[c]);
+        self->batch[c] = NULL;
+        if (!t) {
+            for (int32_t k = c + 1; k < self->num_columns; k++) tensor_free(self->batch[k]);
+            Py_DECREF(out);
+            return NULL;
+        }
+        PyTuple_SET_ITEM(out, c, t);
+    }
+    return out;
+}
+
+static Py_ssize_t PyDataLoader_len(PyDataLoaderObject* self) {
+    if (!self->loader) {
+        return 0;
+    }
+    return (Py_ssize_t)dataloader_num_batches(self->loader);
+}
+
+static PyObject* PyDataLoader_num_records(PyDataLoaderObject* self, PyObject* Py_UNUSED(ignored)) {
+    if (!self->loader) {
+        Py_RETURN_NONE;
+    }
+    return PyLong_FromLongLong(dataloader_num_records(self->loader));
+}
+
+static PyMethodDef PyDataLoader_methods[] = {
+    {"num_records", (PyCFunction)PyDataLoader_num_records, METH_NOARGS, "Return the number of records in the file"},
+    {NULL}  // Sentinel
+};
+
+static PySequenceMethods PyDataLoader_as_sequence = {
+    .sq_length = (lenfunc)PyDataLoader_len,
+};
+
+PyDoc_STRVAR(PyDataLoader__doc__,
+"DataLoader(path, columns, batch_size=1, shuffle=False, seed=0, prefetch=2,\n"
+"           num_workers=1, drop_last=False, format='binary', header=False)\n"
+"--\n\n"
+"Iterate a file of fixed-size records as batches of tensors, one tensor per\n"
+"column. Batches are decoded on background threads, `prefetch` batches\n"
+"ahead, without holding the GIL. Each pass over the loader is one epoch;\n"
+"with shuffle=True the order is reshuffled from `seed` every epoch.\n"
+"\n"
+"Parameters\n"
+"----------\n"
+"path : str\n"
+"    A binary file of packed records, or a CSV file when format='csv'.\n"
+"columns : list[tuple[str, int]]\n"
+"    (dtype, count) for each field of a record. A count of 1 yields a tensor\n"
+"    of shape (batch,), otherwise (batch, count).\n"
+"format : str, optional\n"
+"    'binary' (native byte order, memory-mapped) or 'csv'.\n"
+"header : bool, optional\n"
+"    Skip the first line of a CSV file.\n"
+"\n"
+"Examples\n"
+"-------\n"
+">>> import smol_torch\n"
+">>> loader = smol_torch.DataLoader('train.bin', [('float32', 784), ('int64', 1)],\n"
+"...                                 batch_size=64, shuffle=True)\n"
+">>> for x, y in loader:\n"
+"...     pass\n");
+
+PyTypeObject PyDataLoaderType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "smol_torch.DataLoader",
+    .tp_doc = PyDataLoader__doc__,
+    .tp_basicsize = sizeof(PyDataLoaderObject),
+    .tp_itemsize = 0,
+    .tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,
+    .tp_new = PyDataLoader_new,
+    .tp_init = (initproc)PyDataLoader_init,
+    .tp_dealloc = (destructor)PyDataLoader_dealloc,
+    .tp_iter = (getiterfunc)PyDataLoader_iter,
+    .tp_iternext = (iternextfunc)PyDataLoader_iternext,
+    .tp_as_sequence = &PyDataLoader_as_sequence,
+    .tp_methods = PyDataLoader_methods,
+};
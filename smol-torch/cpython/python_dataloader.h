@@ -0,0 +1,18 @@
+#ifndef PYTHON_DATALOADER_H
+#define PYTHON_DATALOADER_H
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include "dataloader.h"
+
+typedef struct {
+    PyObject_HEAD
+    DataLoader* loader;
+    Tensor** batch;
+    int32_t num_columns;
+    bool busy;            // a call is running with the GIL released
+} PyDataLoaderObject;
+
+extern PyTypeObject PyDataLoaderType;
+
+#endif // PYTHON_DATALOADER_H
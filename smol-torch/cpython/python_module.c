@@ -1,7 +1,13 @@
 #define PY_SSIZE_T_CLEAN
 #include <Python.h>
 
+#include "indexing.h"
 #include "ops.h"
+#include "random.h"
+#include "sparse.h"
+#include "python_dataloader.h"
+#include "python_optim.h"
+#include "python_sparse.h"
 #include "python_tensor.h"
 
 static PyObject* PyTensor_add(PyObject* self, PyObject* args) {
@@ -10,6 +16,21 @@ static PyObject* PyTensor_add(PyObject* self, PyObject* args) {
         return NULL;
     }
 
+    if (PyObject_IsInstance(a_obj, (PyObject*)&PySparseTensorType) &&
+    PyObject_IsInstance(b_obj, (PyObject*)&PySparseTensorType)) {
+        if (!((PySparseTensorObject*)a_obj)->sparse || !((PySparseTensorObject*)b_obj)->sparse) {
+            PyErr_SetString(PyExc_RuntimeError, "SparseTensor is not initialized");
+            return NULL;
+        }
+        SparseTensor* result = sparse_add(((PySparseTensorObject*)a_obj)->sparse,
+                                          ((PySparseTensorObject*)b_obj)->sparse);
+        if (!result) {
+            PyErr_SetString(PyExc_RuntimeError, "Failed to add tensor");
+            return NULL;
+        }
+        return PySparseTensor_wrap(result);
+    }
+
     if (!PyObject_IsInstance(a_obj, (PyObject*)&PyTensorType) ||
     !PyObject_IsInstance(b_obj, (PyObject*)&PyTensorType)) {
         PyErr_SetString(PyExc_TypeError, "Arguments must be Tensor objects");
@@ -27,17 +48,337 @@ static PyObject* PyTensor_add(PyObject* self, PyObject* args) {
         return NULL;
     }
 
-    PyTensorObject* out = PyObject_New(PyTensorObject, &PyTensorType);
-    if (!out) {
-        tensor_free(result);
+    return PyTensor_wrap(result);
+}
+
+static PyObject* PyTensor_manual_seed(PyObject* self, PyObject* args) {
+    unsigned long long seed;
+    if (!PyArg_ParseTuple(args, "K", &seed)) {
+        return NULL;
+    }
+
+    manual_seed((uint64_t)seed);
+    Py_RETURN_NONE;
+}
+
+static PyObject* PyTensor_rand_like(PyObject* args, PyObject* kwds,
+                                    Tensor* (*fn)(int64_t*, int32_t, Dtype)) {
+    PyObject* shape_list;
+    const char* dtype_str = "float32";
+    static char* keywords[] = {"shape", "dtype", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|s", keywords, &shape_list, &dtype_str)) {
+        return NULL;
+    }
+
+    Dtype dtype;
+    if (PyTensor_parse_dtype(dtype_str, &dtype) < 0) {
+        return NULL;
+    }
+    if (dtype != DTYPE_FLOAT32 && dtype != DTYPE_FLOAT64) {
+        PyErr_SetString(PyExc_TypeError, "dtype must be float32 or float64");
+        return NULL;
+    }
+
+    int32_t ndim;
+    int64_t* shape = PyTensor_parse_shape(shape_list, &ndim);
+    if (!shape) {
+        return NULL;
+    }
+
+    Tensor* result = fn(shape, ndim, dtype);
+    free(shape);
+    if (!result) {
+        PyErr_SetString(PyExc_RuntimeError, "Failed to create tensor");
+        return NULL;
+    }
+    return PyTensor_wrap(result);
+}
+
+static PyObject* PyTensor_rand(PyObject* self, PyObject* args, PyObject* kwds) {
+    return PyTensor_rand_like(args, kwds, rand_tensor);
+}
+
+static PyObject* PyTensor_randn(PyObject* self, PyObject* args, PyObject* kwds) {
+    return PyTensor_rand_like(args, kwds, randn_tensor);
+}
+
+static PyObject* PyTensor_randint(PyObject* self, PyObject* args, PyObject* kwds) {
+    long long low, high;
+    PyObject* shape_list;
+    const char* dtype_str = "int64";
+    static char* keywords[] = {"low", "high", "shape", "dtype", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "LLO|s", keywords, &low, &high, &shape_list, &dtype_str)) {
+        return NULL;
+    }
+    if (high <= low) {
+        PyErr_SetString(PyExc_ValueError, "randint expects low < high");
+        return NULL;
+    }
+
+    Dtype dtype;
+    if (PyTensor_parse_dtype(dtype_str, &dtype) < 0) {
+        return NULL;
+    }
+    if (dtype == DTYPE_INT32 && (low < INT32_MIN || high - 1 > INT32_MAX)) {
+        PyErr_SetString(PyExc_ValueError, "randint bounds out of range for int32");
+        return NULL;
+    }
+
+    int32_t ndim;
+    int64_t* shape = PyTensor_parse_shape(shape_list, &ndim);
+    if (!shape) {
+        return NULL;
+    }
+
+    Tensor* result = randint_tensor(low, high, shape, ndim, dtype);
+    free(shape);
+    if (!result) {
+        PyErr_SetString(PyExc_RuntimeError, "Failed to create tensor");
+        return NULL;
+    }
+    return PyTensor_wrap(result);
+}
+
+static PyObject* PyTensor_bernoulli(PyObject* self, PyObject* args) {
+    PyObject* p_obj;
+    if (!PyArg_ParseTuple(args, "O", &p_obj)) {
+        return NULL;
+    }
+
+    const Tensor* p = PyTensor_get(p_obj);
+    if (!p) {
+        return NULL;
+    }
+
+    Tensor* result = bernoulli_tensor(p);
+    if (!result) {
+        PyErr_SetString(PyExc_RuntimeError, "Failed to sample bernoulli");
+        return NULL;
+    }
+    return PyTensor_wrap(result);
+}
+
+static PyObject* PyTensor_dropout(PyObject* self, PyObject* args, PyObject* kwds) {
+    PyObject* a_obj;
+    double p = 0.5;
+    int training = 1;
+    static char* keywords[] = {"input", "p", "training", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|dp", keywords, &a_obj, &p, &training)) {
+        return NULL;
+    }
+
+    const Tensor* a = PyTensor_get(a_obj);
+    if (!a) {
+        return NULL;
+    }
+    if (p < 0.0 || p > 1.0) {
+        PyErr_SetString(PyExc_ValueError, "dropout probability must be in [0, 1]");
+        return NULL;
+    }
+
+    Tensor* result = dropout_tensor(a, p, training);
+    if (!result) {
+        PyErr_SetString(PyExc_RuntimeError, "Failed to apply dropout");
+        return NULL;
+    }
+    return PyTensor_wrap(result);
+}
+
+static PyObject* PyTensor_matmul(PyObject* self, PyObject* args) {
+    PyObject *a_obj, *b_obj;
+    if (!PyArg_ParseTuple(args, "OO", &a_obj, &b_obj)) {
+        return NULL;
+    }
+
+    if (!PyObject_IsInstance(a_obj, (PyObject*)&PySparseTensorType) ||
+    !PyObject_IsInstance(b_obj, (PyObject*)&PyTensorType)) {
+        PyErr_SetString(PyExc_TypeError, "matmul expects a SparseTensor and a Tensor");
+        return NULL;
+    }
+
+    if (!((PySparseTensorObject*)a_obj)->sparse) {
+        PyErr_SetString(PyExc_RuntimeError, "SparseTensor is not initialized");
+        return NULL;
+    }
+    const Tensor* b = PyTensor_get(b_obj);
+    if (!b) {
+        return NULL;
+    }
+
+    Tensor* result = sparse_matmul(((PySparseTensorObject*)a_obj)->sparse, b);
+    if (!result) {
+        PyErr_SetString(PyExc_RuntimeError, "Failed to multiply tensors");
+        return NULL;
+    }
+    return PyTensor_wrap(result);
+}
+
+static PyObject* PyTensor_to_sparse(PyObject* self, PyObject* args, PyObject* kwds) {
+    PyObject* a_obj;
+    const char* layout_str = "csr";
+    static char* keywords[] = {"input", "layout", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|s", keywords, &a_obj, &layout_str)) {
+        return NULL;
+    }
+
+    if (!PyObject_IsInstance(a_obj, (PyObject*)&PyTensorType)) {
+        PyErr_SetString(PyExc_TypeError, "Argument must be a Tensor object");
+        return NULL;
+    }
+
+    SparseLayout layout;
+    if (PySparseTensor_parse_layout(layout_str, &layout) < 0) {
+        return NULL;
+    }
+
+    const Tensor* a = PyTensor_get(a_obj);
+    if (!a) {
+        return NULL;
+    }
+    if (a->ndim != 2) {
+        PyErr_SetString(PyExc_ValueError, "Sparse tensors must be 2-D");
+        return NULL;
+    }
+
+    SparseTensor* result = sparse_from_dense(a, layout);
+    if (!result) {
+        PyErr_SetString(PyExc_RuntimeError, "Failed to convert to sparse");
+        return NULL;
+    }
+    return PySparseTensor_wrap(result);
+}
+
+static bool all_tensors(PyObject** objs, int n) {
+    for (int i = 0; i < n; i++) {
+        if (!PyTensor_get(objs[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static PyObject* PyTensor_index_select(PyObject* self, PyObject* args) {
+    PyObject *a_obj, *index_obj;
+    int dim;
+    if (!PyArg_ParseTuple(args, "OiO", &a_obj, &dim, &index_obj)) {
+        return NULL;
+    }
+    if (!all_tensors((PyObject*[]){a_obj, index_obj}, 2)) {
+        return NULL;
+    }
+
+    Tensor* result = index_select_tensor(((PyTensorObject*)a_obj)->tensor, dim, ((PyTensorObject*)index_obj)->tensor);
+    if (!result) {
+        PyErr_SetString(PyExc_IndexError, "Invalid dim or index for index_select");
         return NULL;
     }
-    out->tensor = result;
-    return (PyObject*)out;
+    return PyTensor_wrap(result);
+}
+
+static PyObject* PyTensor_gather(PyObject* self, PyObject* args) {
+    PyObject *a_obj, *index_obj;
+    int dim;
+    if (!PyArg_ParseTuple(args, "OiO", &a_obj, &dim, &index_obj)) {
+        return NULL;
+    }
+    if (!all_tensors((PyObject*[]){a_obj, index_obj}, 2)) {
+        return NULL;
+    }
+
+    Tensor* result = gather_tensor(((PyTensorObject*)a_obj)->tensor, dim, ((PyTensorObject*)index_obj)->tensor);
+    if (!result) {
+        PyErr_SetString(PyExc_IndexError, "Invalid dim or index for gather");
+        return NULL;
+    }
+    return PyTensor_wrap(result);
+}
+
+static PyObject* PyTensor_scatter_add(PyObject* self, PyObject* args) {
+    PyObject *a_obj, *index_obj, *src_obj;
+    int dim;
+    if (!PyArg_ParseTuple(args, "OiOO", &a_obj, &dim, &index_obj, &src_obj)) {
+        return NULL;
+    }
+    if (!all_tensors((PyObject*[]){a_obj, index_obj, src_obj}, 3)) {
+        return NULL;
+    }
+
+    Tensor* result = scatter_add_tensor(((PyTensorObject*)a_obj)->tensor, dim,
+                                        ((PyTensorObject*)index_obj)->tensor, ((PyTensorObject*)src_obj)->tensor);
+    if (!result) {
+        PyErr_SetString(PyExc_IndexError, "Invalid dim, index or src for scatter_add");
+        return NULL;
+    }
+    return PyTensor_wrap(result);
+}
+
+static PyObject* PyTensor_masked_select(PyObject* self, PyObject* args) {
+    PyObject *a_obj, *mask_obj;
+    if (!PyArg_ParseTuple(args, "OO", &a_obj, &mask_obj)) {
+        return NULL;
+    }
+    if (!all_tensors((PyObject*[]){a_obj, mask_obj}, 2)) {
+        return NULL;
+    }
+
+    Tensor* result = masked_select_tensor(((PyTensorObject*)a_obj)->tensor, ((PyTensorObject*)mask_obj)->tensor);
+    if (!result) {
+        PyErr_SetString(PyExc_ValueError, "Mask must be an int tensor of the input's shape selecting at least one element");
+        return NULL;
+    }
+    return PyTensor_wrap(result);
+}
+
+static PyObject* PyTensor_embedding_bag(PyObject* self, PyObject* args, PyObject* kwds) {
+    PyObject *weight_obj, *indices_obj, *offsets_obj;
+    const char* mode_str = "mean";
+    static char* keywords[] = {"weight", "indices", "offsets", "mode", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "OOO|s", keywords, &weight_obj, &indices_obj, &offsets_obj, &mode_str)) {
+        return NULL;
+    }
+    if (!all_tensors((PyObject*[]){weight_obj, indices_obj, offsets_obj}, 3)) {
+        return NULL;
+    }
+
+    EmbeddingBagMode mode;
+    if (strcmp(mode_str, "sum") == 0) {
+        mode = EMBEDDING_BAG_SUM;
+    } else if (strcmp(mode_str, "mean") == 0) {
+        mode = EMBEDDING_BAG_MEAN;
+    } else {
+        PyErr_SetString(PyExc_ValueError, "Unsupported mode, expected 'sum' or 'mean'");
+        return NULL;
+    }
+
+    Tensor* result = embedding_bag_tensor(((PyTensorObject*)weight_obj)->tensor, ((PyTensorObject*)indices_obj)->tensor,
+                                          ((PyTensorObject*)offsets_obj)->tensor, mode);
+    if (!result) {
+        PyErr_SetString(PyExc_IndexError, "Invalid weight, indices or offsets for embedding_bag");
+        return NULL;
+    }
+    return PyTensor_wrap(result);
 }
 
 static PyMethodDef smol_torch_methods[] = {
     {"add", (PyCFunction)PyTensor_add, METH_VARARGS, "Add two tensors"},
+    {"matmul", (PyCFunction)PyTensor_matmul, METH_VARARGS, "Multiply a sparse matrix by a dense vector or matrix"},
+    {"to_sparse", (PyCFunction)PyTensor_to_sparse, METH_VARARGS | METH_KEYWORDS, "Convert a 2-D tensor to a SparseTensor"},
+    {"index_select", (PyCFunction)PyTensor_index_select, METH_VARARGS, "Select slices along dim by an index tensor"},
+    {"gather", (PyCFunction)PyTensor_gather, METH_VARARGS, "Gather values along dim by an index tensor"},
+    {"scatter_add", (PyCFunction)PyTensor_scatter_add, METH_VARARGS, "Add src into a copy of the input at the indexed positions"},
+    {"masked_select", (PyCFunction)PyTensor_masked_select, METH_VARARGS, "Return the elements where mask is non-zero as a 1-D tensor"},
+    {"embedding_bag", (PyCFunction)PyTensor_embedding_bag, METH_VARARGS | METH_KEYWORDS, "Sum or mean of embedding rows per bag"},
+    {"manual_seed", (PyCFunction)PyTensor_manual_seed, METH_VARARGS, "Seed the random number generator"},
+    {"rand", (PyCFunction)PyTensor_rand, METH_VARARGS | METH_KEYWORDS, "Uniform samples in [0, 1)"},
+    {"randn", (PyCFunction)PyTensor_randn, METH_VARARGS | METH_KEYWORDS, "Standard normal samples"},
+    {"randint", (PyCFunction)PyTensor_randint, METH_VARARGS | METH_KEYWORDS, "Integer samples in [low, high)"},
+    {"bernoulli", (PyCFunction)PyTensor_bernoulli, METH_VARARGS, "Draw 0/1 samples with the given probabilities"},
+    {"dropout", (PyCFunction)PyTensor_dropout, METH_VARARGS | METH_KEYWORDS, "Randomly zero elements with probability p"},
     {NULL, NULL, 0, NULL}
 };
 
@@ -54,6 +395,11 @@ PyMODINIT_FUNC PyInit_smol_torch(void) {
     if (!module) return NULL;
 
     if (PyType_Ready(&PyTensorType) < 0) return NULL;
+    if (PyType_Ready(&PySparseTensorType) < 0) return NULL;
+    if (PyType_Ready(&PyDataLoaderType) < 0) return NULL;
+    if (PyType_Ready(&PySGDType) < 0) return NULL;
+    if (PyType_Ready(&PyAdamType) < 0) return NULL;
+    if (PyType_Ready(&PyAdamWType) < 0) return NULL;
 
     Py_INCREF(&PyTensorType);
     if (PyModule_AddObject(module, "Tensor", (PyObject*)&PyTensorType) < 0) {
@@ -62,5 +408,36 @@ PyMODINIT_FUNC PyInit_smol_torch(void) {
         return NULL;
     }
 
+    Py_INCREF(&PySparseTensorType);
+    if (PyModule_AddObject(module, "SparseTensor", (PyObject*)&PySparseTensorType) < 0) {
+        Py_DECREF(&PySparseTensorType);
+        Py_DECREF(module);
+        return NULL;
+    }
+    Py_INCREF(&PyDataLoaderType);
+    if (PyModule_AddObject(module, "DataLoader", (PyObject*)&PyDataLoaderType) < 0) {
+        Py_DECREF(&PyDataLoaderType);
+        Py_DECREF(module);
+        return NULL;
+    }
+    Py_INCREF(&PySGDType);
+    if (PyModule_AddObject(module, "SGD", (PyObject*)&PySGDType) < 0) {
+        Py_DECREF(&PySGDType);
+        Py_DECREF(module);
+        return NULL;
+    }
+    Py_INCREF(&PyAdamType);
+    if (PyModule_AddObject(module, "Adam", (PyObject*)&PyAdamType) < 0) {
+        Py_DECREF(&PyAdamType);
+        Py_DECREF(module);
+        return NULL;
+    }
+    Py_INCREF(&PyAdamWType);
+    if (PyModule_AddObject(module, "AdamW", (PyObject*)&PyAdamWType) < 0) {
+        Py_DECREF(&PyAdamWType);
+        Py_DECREF(module);
+        return NULL;
+    }
+
     return module;
 }
\ No newline at end of file
@@ -0,0 +1,398 @@
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <stdlib.h>
+
+#include "python_optim.h"
+#include "python_tensor.h"
+
+static void free_tensor_list(Tensor** tensors, const int32_t n) {
+    if (!tensors) return;
+    for (int32_t i = 0; i < n; i++) tensor_free(tensors[i]);
+    free(tensors);
+}
+
+static void PyOptimizer_clear(PyOptimizerObject* self) {
+    free_tensor_list(self->masters, self->num_params);
+    for (int s = 0; s < self->num_states; s++) free_tensor_list(self->state[s], self->num_params);
+    Py_CLEAR(self->params);
+    self->masters = NULL;
+    self->state[0] = self->state[1] = NULL;
+    self->num_params = 0;
+    self->num_states = 0;
+    self->step = 0;
+}
+
+static void PyOptimizer_dealloc(PyOptimizerObject* self) {
+    PyOptimizer_clear(self);
+    Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+static PyObject* PyOptimizer_new(PyTypeObject* type, PyObject* args, PyObject* kwds) {
+    PyOptimizerObject* self = (PyOptimizerObject*)type->tp_alloc(type, 0);
+    if (self) {
+        self->params = NULL;
+        self->masters = NULL;
+        self->state[0] = self->state[1] = NULL;
+        self->num_params = 0;
+        self->num_states = 0;
+        self->step = 0;
+    }
+    return (PyObject*)self;
+}
+
+static Tensor* zeros_like(const Tensor* t, const Dtype dtype) {
+    return create_tensor(t->shape, t->ndim, dtype);
+}
+
+// Takes the parameter list and allocates zeroed optimizer state (and float64
+// master copies of float32 parameters when requested) for each parameter.
+static int setup_params(PyOptimizerObject* self, PyObject* params_obj, const int master_weights,
+                        const int32_t num_states) {
+    PyOptimizer_clear(self);
+
+    PyObject* params = PySequence_Tuple(params_obj);
+    if (!params) return -1;
+
+    const Py_ssize_t n = PyTuple_GET_SIZE(params);
+    if (n == 0 || n > INT32_MAX) {
+        Py_DECREF(params);
+        PyErr_SetString(PyExc_ValueError, "params must be a non-empty list of Tensors");
+        return -1;
+    }
+    for (Py_ssize_t i = 0; i < n; i++) {
+        PyObject* item = PyTuple_GET_ITEM(params, i);
+        if (!PyObject_IsInstance(item, (PyObject*)&PyTensorType)) {
+            Py_DECREF(params);
+            PyErr_SetString(PyExc_TypeError, "params must be a non-empty list of Tensors");
+            return -1;
+        }
+        const Tensor* p = PyTensor_get(item);
+        if (!p) {
+            Py_DECREF(params);
+            return -1;
+        }
+        const Dtype dtype = p->dtype;
+        if (dtype != DTYPE_FLOAT32 && dtype != DTYPE_FLOAT64) {
+            Py_DECREF(params);
+            PyErr_SetString(PyExc_TypeError, "Optimizers only support float32 and float64 parameters");
+            return -1;
+        }
+    }
+
+    self->params = params;
+    self->num_params = (int32_t)n;
+    self->num_states = num_states;
+    if (master_weights) {
+        self->masters = calloc(n, sizeof(Tensor*));
+        if (!self->masters) goto fail;
+    }
+    for (int s = 0; s < num_states; s++) {
+        self->state[s] = calloc(n, sizeof(Tensor*));
+        if (!self->state[s]) goto fail;
+    }
+
+    for (int32_t i = 0; i < self->num_params; i++) {
+        const Tensor* p = ((PyTensorObject*)PyTuple_GET_ITEM(params, i))->tensor;
+        Dtype state_dtype = p->dtype;
+        if (self->masters && p->dtype == DTYPE_FLOAT32) {
+            self->masters[i] = zeros_like(p, DTYPE_FLOAT64);
+            if (!self->masters[i]) goto fail;
+            dtype_cast(self->masters[i]->data, DTYPE_FLOAT64, p->data, DTYPE_FLOAT32, p->size);
+            state_dtype = DTYPE_FLOAT64;
+        }
+        for (int s = 0; s < num_states; s++) {
+            self->state[s][i] = zeros_like(p, state_dtype);
+            if (!self->state[s][i]) goto fail;
+        }
+    }
+    return 0;
+
+fail:
+    PyOptimizer_clear(self);
+    PyErr_SetString(PyExc_RuntimeError, "Failed to allocate optimizer state");
+    return -1;
+}
+
+static int PySGD_init(PyOptimizerObject* self, PyObject* args, PyObject* kwds) {
+    PyObject* params;
+    double lr;
+    double momentum = 0.0;
+    double dampening = 0.0;
+    double weight_decay = 0.0;
+    int nesterov = 0;
+    int master_weights = 0;
+    static char* keywords[] = {"params", "lr", "momentum", "dampening", "weight_decay", "nesterov",
+                               "master_weights", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "Od|dddpp", keywords, &params, &lr, &momentum, &dampening,
+                                     &weight_decay, &nesterov, &master_weights)) {
+        return -1;
+    }
+    if (lr < 0.0 || momentum < 0.0 || weight_decay < 0.0) {
+        PyErr_SetString(PyExc_ValueError, "lr, momentum and weight_decay must be non-negative");
+        return -1;
+    }
+    if (nesterov && (momentum == 0.0 || dampening != 0.0)) {
+        PyErr_SetString(PyExc_ValueError, "Nesterov momentum requires a momentum and zero dampening");
+        return -1;
+    }
+
+    if (setup_params(self, params, master_weights, momentum != 0.0 ? 1 : 0) < 0) return -1;
+    self->kind = OPTIM_SGD;
+    self->sgd = (SgdOptions){
+        .lr = lr,
+        .momentum = momentum,
+        .dampening = dampening,
+        .weight_decay = weight_decay,
+        .nesterov = nesterov,
+    };
+    return 0;
+}
+
+static int adam_init(PyOptimizerObject* self, PyObject* args, PyObject* kwds, const double default_weight_decay,
+                     const bool decoupled) {
+    PyObject* params;
+    double lr = 1e-3;
+    double beta1 = 0.9;
+    double beta2 = 0.999;
+    double eps = 1e-8;
+    double weight_decay = default_weight_decay;
+    int master_weights = 0;
+    static char* keywords[] = {"params", "lr", "betas", "eps", "weight_decay", "master_weights", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|d(dd)ddp", keywords, &params, &lr, &beta1, &beta2, &eps,
+                                     &weight_decay, &master_weights)) {
+        return -1;
+    }
+    if (lr < 0.0 || eps < 0.0 || weight_decay < 0.0) {
+        PyErr_SetString(PyExc_ValueError, "lr, eps and weight_decay must be non-negative");
+        return -1;
+    }
+    if (beta1 < 0.0 || beta1 >= 1.0 || beta2 < 0.0 || beta2 >= 1.0) {
+        PyErr_SetString(PyExc_ValueError, "betas must be in [0, 1)");
+        return -1;
+    }
+
+    if (setup_params(self, params, master_weights, 2) < 0) return -1;
+    self->kind = OPTIM_ADAM;
+    self->adam = (AdamOptions){
+        .lr = lr,
+        .beta1 = beta1,
+        .beta2 = beta2,
+        .eps = eps,
+        .weight_decay = weight_decay,
+        .decoupled_weight_decay = decoupled,
+    };
+    return 0;
+}
+
+static int PyAdam_init(PyOptimizerObject* self, PyObject* args, PyObject* kwds) {
+    return adam_init(self, args, kwds, 0.0, false);
+}
+
+static int PyAdamW_init(PyOptimizerObject* self, PyObject* args, PyObject* kwds) {
+    return adam_init(self, args, kwds, 1e-2, true);
+}
+
+static PyObject* PyOptimizer_step(PyOptimizerObject* self, PyObject* args) {
+    PyObject* grads_obj;
+    if (!PyArg_ParseTuple(args, "O", &grads_obj)) {
+        return NULL;
+    }
+    if (!self->params) {
+        PyErr_SetString(PyExc_RuntimeError, "Optimizer is not initialized");
+        return NULL;
+    }
+
+    // Hold on to the gradients while the GIL is released.
+    PyObject* grads_tuple = PySequence_Tuple(grads_obj);
+    if (!grads_tuple) return NULL;
+    if (PyTuple_GET_SIZE(grads_tuple) != self->num_params) {
+        Py_DECREF(grads_tuple);
+        PyErr_SetString(PyExc_ValueError, "Expected one gradient per parameter");
+        return NULL;
+    }
+
+    const int32_t n = self->num_params;
+    Tensor** params = malloc(sizeof(Tensor*) * n);
+    Tensor** grads = malloc(sizeof(Tensor*) * n);
+    if (!params || !grads) {
+        free(params);
+        free(grads);
+        Py_DECREF(grads_tuple);
+        PyErr_SetString(PyExc_RuntimeError, "Memory allocation failed");
+        return NULL;
+    }
+    for (int32_t i = 0; i < n; i++) {
+        params[i] = PyTensor_get(PyTuple_GET_ITEM(self->params, i));
+        grads[i] = params[i] ? PyTensor_get(PyTuple_GET_ITEM(grads_tuple, i)) : NULL;
+        if (!grads[i]) {
+            free(params);
+            free(grads);
+            Py_DECREF(grads_tuple);
+            return NULL;
+        }
+    }
+
+    const int64_t step = self->step + 1;
+    int status;
+    Py_BEGIN_ALLOW_THREADS
+    if (self->kind == OPTIM_SGD) {
+        status = sgd_step(params, grads, self->state[0], self->masters, n, step, &self->sgd);
+    } else {
+        status = adam_step(params, grads, self->state[0], self->state[1], self->masters, n, step, &self->adam);
+    }
+    Py_END_ALLOW_THREADS
+
+    free(params);
+    free(grads);
+    Py_DECREF(grads_tuple);
+    if (status < 0) {
+        PyErr_SetString(PyExc_RuntimeError, "Optimizer step failed, gradients must match their parameters");
+        return NULL;
+    }
+    self->step = step;
+    Py_RETURN_NONE;
+}
+
+static PyObject* PyOptimizer_get_lr(PyOptimizerObject* self, void* closure) {
+    return PyFloat_FromDouble(self->kind == OPTIM_SGD ? self->sgd.lr : self->adam.lr);
+}
+
+static int PyOptimizer_set_lr(PyOptimizerObject* self, PyObject* value, void* closure) {
+    if (!value) {
+        PyErr_SetString(PyExc_TypeError, "Cannot delete the learning rate");
+        return -1;
+    }
+    const double lr = PyFloat_AsDouble(value);
+    if (lr == -1.0 && PyErr_Occurred()) return -1;
+    if (lr < 0.0) {
+        PyErr_SetString(PyExc_ValueError, "lr must be non-negative");
+        return -1;
+    }
+    if (self->kind == OPTIM_SGD) {
+        self->sgd.lr = lr;
+    } else {
+        self->adam.lr = lr;
+    }
+    return 0;
+}
+
+static PyObject* PyOptimizer_get_steps(PyOptimizerObject* self, void* closure) {
+    return PyLong_FromLongLong(self->step);
+}
+
+static PyGetSetDef PyOptimizer_getset[] = {
+    {"lr", (getter)PyOptimizer_get_lr, (setter)PyOptimizer_set_lr, "Learning rate used by the next step", NULL},
+    {"steps", (getter)PyOptimizer_get_steps, NULL, "Number of steps taken so far", NULL},
+    {NULL}  // Sentinel
+};
+
+PyDoc_STRVAR(PyOptimizer_step__doc__,
+"step(grads)\n"
+"--\n\n"
+"Update every parameter in place from its gradient, in one fused pass over\n"
+"parameters, gradients and optimizer state. The GIL is released while the\n"
+"update runs.\n"
+"\n"
+"Parameters\n"
+"----------\n"
+"grads : list[Tensor]\n"
+"    One gradient per parameter, with the parameter's dtype and shape.\n");
+
+static PyMethodDef PyOptimizer_methods[] = {
+    {"step", (PyCFunction)PyOptimizer_step, METH_VARARGS, PyOptimizer_step__doc__},
+    {NULL}  // Sentinel
+};
+
+PyDoc_STRVAR(PySGD__doc__,
+"SGD(params, lr, momentum=0.0, dampening=0.0, weight_decay=0.0, nesterov=False,\n"
+"    master_weights=False)\n"
+"--\n\n"
+"Stochastic gradient descent with optional (Nesterov) momentum.\n"
+"\n"
+"Parameters\n"
+"----------\n"
+"params : list[Tensor]\n"
+"    float32 or float64 tensors, updated in place by step().\n"
+"master_weights : bool, optional\n"
+"    Keep a float64 copy of each float32 parameter and run the update on it;\n"
+"    the parameter receives the rounded result. Momentum is then float64 too.\n"
+"\n"
+"Examples\n"
+"-------\n"
+">>> import smol_torch\n"
+">>> w = smol_torch.randn([256, 128])\n"
+">>> opt = smol_torch.SGD([w], lr=0.1, momentum=0.9)\n"
+">>> opt.step([smol_torch.randn([256, 128])])\n");
+
+PyDoc_STRVAR(PyAdam__doc__,
+"Adam(params, lr=1e-3, betas=(0.9, 0.999), eps=1e-8, weight_decay=0.0,\n"
+"     master_weights=False)\n"
+"--\n\n"
+"Adam, with weight decay added to the gradient (L2 regularisation).\n"
+"\n"
+"Parameters\n"
+"----------\n"
+"params : list[Tensor]\n"
+"    float32 or float64 tensors, updated in place by step().\n"
+"master_weights : bool, optional\n"
+"    Keep a float64 copy of each float32 parameter and run the update on it;\n"
+"    the parameter receives the rounded result. Both moments are then float64.\n"
+"\n"
+"Examples\n"
+"-------\n"
+">>> import smol_torch\n"
+">>> w = smol_torch.randn([256, 128])\n"
+">>> opt = smol_torch.Adam([w], lr=1e-3)\n"
+">>> opt.step([smol_torch.randn([256, 128])])\n");
+
+PyDoc_STRVAR(PyAdamW__doc__,
+"AdamW(params, lr=1e-3, betas=(0.9, 0.999), eps=1e-8, weight_decay=1e-2,\n"
+"      master_weights=False)\n"
+"--\n\n"
+"Adam with decoupled weight decay: weights shrink by lr * weight_decay each\n"
+"step instead of the decay being folded into the gradient. Parameters are\n"
+"as for Adam.\n");
+
+PyTypeObject PySGDType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "smol_torch.SGD",
+    .tp_doc = PySGD__doc__,
+    .tp_basicsize = sizeof(PyOptimizerObject),
+    .tp_itemsize = 0,
+    .tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,
+    .tp_new = PyOptimizer_new,
+    .tp_init = (initproc)PySGD_init,
+    .tp_dealloc = (destructor)PyOptimizer_dealloc,
+    .tp_methods = PyOptimizer_methods,
+    .tp_getset = PyOptimizer_getset,
+};
+
+PyTypeObject PyAdamType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "smol_torch.Adam",
+    .tp_doc = PyAdam__doc__,
+    .tp_basicsize = sizeof(PyOptimizerObject),
+    .tp_itemsize = 0,
+    .tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,
+    .tp_new = PyOptimizer_new,
+    .tp_init = (initproc)PyAdam_init,
+    .tp_dealloc = (destructor)PyOptimizer_dealloc,
+    .tp_methods = PyOptimizer_methods,
+    .tp_getset = PyOptimizer_getset,
+};
+
+PyTypeObject PyAdamWType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "smol_torch.AdamW",
+    .tp_doc = PyAdamW__doc__,
+    .tp_basicsize = sizeof(PyOptimizerObject),
+    .tp_itemsize = 0,
+    .tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,
+    .tp_new = PyOptimizer_new,
+    .tp_init = (initproc)PyAdamW_init,
+    .tp_dealloc = (destructor)PyOptimizer_dealloc,
+    .tp_methods = PyOptimizer_methods,
+    .tp_getset = PyOptimizer_getset,
+};
@@ -0,0 +1,30 @@
+#ifndef PYTHON_OPTIM_H
+#define PYTHON_OPTIM_H
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include "optim.h"
+
+typedef enum {
+    OPTIM_SGD,
+    OPTIM_ADAM
+} OptimKind;
+
+typedef struct {
+    PyObject_HEAD
+    OptimKind kind;
+    PyObject* params;     // tuple of Tensor objects
+    Tensor** masters;     // NULL unless float64 master weights are kept
+    Tensor** state[2];    // momentum buffers, or exp_avg and exp_avg_sq
+    int32_t num_params;
+    int32_t num_states;
+    int64_t step;
+    SgdOptions sgd;
+    AdamOptions adam;
+} PyOptimizerObject;
+
+extern PyTypeObject PySGDType;
+extern PyTypeObject PyAdamType;
+extern PyTypeObject PyAdamWType;
+
+#endif // PYTHON_OPTIM_H
@@ -0,0 +1,341 @@
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sparse.h"
+#include "python_sparse.h"
+#include "python_tensor.h"
+
+static void PySparseTensor_dealloc(PySparseTensorObject* self) {
+    if (self->sparse)
+        sparse_free(self->sparse);
+    Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+static PyObject* PySparseTensor_new(PyTypeObject* type, PyObject* args, PyObject* kwds) {
+    PySparseTensorObject* self = (PySparseTensorObject*)type->tp_alloc(type, 0);
+    if (self) {
+        self->sparse = NULL;
+    }
+    return (PyObject*)self;
+}
+
+int PySparseTensor_parse_layout(const char* layout_str, SparseLayout* layout) {
+    if (strcmp(layout_str, "coo") == 0) {
+        *layout = SPARSE_COO;
+    } else if (strcmp(layout_str, "csr") == 0) {
+        *layout = SPARSE_CSR;
+    } else {
+        PyErr_SetString(PyExc_ValueError, "Unsupported layout, expected 'coo' or 'csr'");
+        return -1;
+    }
+    return 0;
+}
+
+PyObject* PySparseTensor_wrap(SparseTensor* sparse) {
+    PySparseTensorObject* out = PyObject_New(PySparseTensorObject, &PySparseTensorType);
+    if (!out) {
+        sparse_free(sparse);
+        return NULL;
+    }
+    out->sparse = sparse;
+    return (PyObject*)out;
+}
+
+static int64_t* parse_index_list(PyObject* list, const char* name, Py_ssize_t* len) {
+    if (!PyList_Check(list)) {
+        PyErr_Format(PyExc_TypeError, "%s must be a list of integers", name);
+        return NULL;
+    }
+
+    *len = PyList_Size(list);
+    int64_t* out = malloc(sizeof(int64_t) * (*len > 0 ? *len : 1));
+    if (!out) {
+        PyErr_SetString(PyExc_RuntimeError, "Memory allocation failed");
+        return NULL;
+    }
+
+    for (Py_ssize_t i = 0; i < *len; i++) {
+        PyObject* item = PyList_GetItem(list, i);
+        if (!PyLong_Check(item)) {
+            free(out);
+            PyErr_Format(PyExc_TypeError, "%s elements must be integers", name);
+            return NULL;
+        }
+        out[i] = PyLong_AsLongLong(item);
+    }
+    return out;
+}
+
+static void* parse_value_list(PyObject* list, const Dtype dtype, Py_ssize_t* len) {
+    if (!PyList_Check(list)) {
+        PyErr_SetString(PyExc_TypeError, "values must be a list");
+        return NULL;
+    }
+
+    *len = PyList_Size(list);
+    void* out = malloc(get_tensor_dtype_size(dtype) * (*len > 0 ? *len : 1));
+    if (!out) {
+        PyErr_SetString(PyExc_RuntimeError, "Memory allocation failed");
+        return NULL;
+    }
+
+    for (Py_ssize_t i = 0; i < *len; i++) {
+        PyObject* item = PyList_GetItem(list, i);
+        const bool is_float = dtype == DTYPE_FLOAT32 || dtype == DTYPE_FLOAT64;
+        if (!PyLong_Check(item) && !(is_float && PyFloat_Check(item))) {
+            free(out);
+            PyErr_Format(PyExc_TypeError, "Data elements for dtype %s must be %s",
+                         dtype_name(dtype), is_float ? "float or int" : "int");
+            return NULL;
+        }
+
+        switch (dtype) {
+            case DTYPE_FLOAT32: ((float*)out)[i] = (float)PyFloat_AsDouble(item); break;
+            case DTYPE_FLOAT64: ((double*)out)[i] = PyFloat_AsDouble(item); break;
+            case DTYPE_INT32: ((int32_t*)out)[i] = (int32_t)PyLong_AsLong(item); break;
+            case DTYPE_INT64: ((int64_t*)out)[i] = PyLong_AsLongLong(item); break;
+            default: break;
+        }
+    }
+    return out;
+}
+
+static int PySparseTensor_init(PySparseTensorObject* self, PyObject* args, PyObject* kwds) {
+    PyObject *rows_list, *cols_list, *values_list, *shape_list;
+    const char* dtype_str = "float32";
+    const char* layout_str = "coo";
+
+    static char* keywords[] = {"rows", "cols", "values", "shape", "dtype", "layout", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "OOOO|ss", keywords, &rows_list, &cols_list,
+                                     &values_list, &shape_list, &dtype_str, &layout_str)) {
+        return -1;
+    }
+
+    Dtype dtype;
+    SparseLayout layout;
+    if (PyTensor_parse_dtype(dtype_str, &dtype) < 0 || PySparseTensor_parse_layout(layout_str, &layout) < 0) {
+        return -1;
+    }
+
+    int32_t ndim;
+    int64_t* shape = PyTensor_parse_shape(shape_list, &ndim);
+    if (!shape) {
+        return -1;
+    }
+    if (ndim != 2) {
+        free(shape);
+        PyErr_SetString(PyExc_ValueError, "Sparse tensors must be 2-D");
+        return -1;
+    }
+
+    Py_ssize_t n_rows, n_cols, n_values;
+    int64_t* rows = parse_index_list(rows_list, "rows", &n_rows);
+    int64_t* cols = rows ? parse_index_list(cols_list, "cols", &n_cols) : NULL;
+    void* values = cols ? parse_value_list(values_list, dtype, &n_values) : NULL;
+    if (!values) {
+        free(shape);
+        free(rows);
+        free(cols);
+        return -1;
+    }
+
+    if (n_rows != n_cols || n_rows != n_values) {
+        free(shape);
+        free(rows);
+        free(cols);
+        free(values);
+        PyErr_SetString(PyExc_ValueError, "rows, cols and values must have the same length");
+        return -1;
+    }
+
+    for (Py_ssize_t i = 0; i < n_rows; i++) {
+        if (rows[i] < 0 || rows[i] >= shape[0] || cols[i] < 0 || cols[i] >= shape[1]) {
+            PyErr_Format(PyExc_IndexError, "Index (%lld, %lld) out of bounds for shape (%lld, %lld)",
+                         (long long)rows[i], (long long)cols[i], (long long)shape[0], (long long)shape[1]);
+            free(shape);
+            free(rows);
+            free(cols);
+            free(values);
+            return -1;
+        }
+    }
+
+    SparseTensor* coo = create_sparse_coo(rows, cols, values, n_rows, shape, dtype);
+    free(shape);
+    free(rows);
+    free(cols);
+    free(values);
+
+    if (coo && layout == SPARSE_CSR) {
+        self->sparse = sparse_to_csr(coo);
+        sparse_free(coo);
+    } else {
+        self->sparse = coo;
+    }
+
+    if (!self->sparse) {
+        PyErr_SetString(PyExc_RuntimeError, "Failed to create sparse tensor");
+        return -1;
+    }
+
+    return 0;
+}
+
+static PyObject* PySparseTensor_shape(PySparseTensorObject* self, PyObject* Py_UNUSED(ignored)) {
+    if (!self->sparse) {
+        Py_RETURN_NONE;
+    }
+    return Py_BuildValue("(LL)", (long long)self->sparse->shape[0], (long long)self->sparse->shape[1]);
+}
+
+static PyObject* PySparseTensor_nnz(PySparseTensorObject* self, PyObject* Py_UNUSED(ignored)) {
+    if (!self->sparse) {
+        Py_RETURN_NONE;
+    }
+    return PyLong_FromLongLong(self->sparse->nnz);
+}
+
+static PyObject* PySparseTensor_layout(PySparseTensorObject* self, PyObject* Py_UNUSED(ignored)) {
+    if (!self->sparse) {
+        Py_RETURN_NONE;
+    }
+    return PyUnicode_FromString(self->sparse->layout == SPARSE_CSR ? "csr" : "coo");
+}
+
+static PyObject* PySparseTensor_to_dense(PySparseTensorObject* self, PyObject* Py_UNUSED(ignored)) {
+    if (!self->sparse) {
+        PyErr_SetString(PyExc_RuntimeError, "SparseTensor is not initialized");
+        return NULL;
+    }
+    Tensor* result = sparse_to_dense(self->sparse);
+    if (!result) {
+        PyErr_SetString(PyExc_RuntimeError, "Failed to convert to dense");
+        return NULL;
+    }
+    return PyTensor_wrap(result);
+}
+
+static PyObject* PySparseTensor_to_csr(PySparseTensorObject* self, PyObject* Py_UNUSED(ignored)) {
+    if (!self->sparse) {
+        PyErr_SetString(PyExc_RuntimeError, "SparseTensor is not initialized");
+        return NULL;
+    }
+    SparseTensor* result = sparse_to_csr(self->sparse);
+    if (!result) {
+        PyErr_SetString(PyExc_RuntimeError, "Failed to convert to csr");
+        return NULL;
+    }
+    return PySparseTensor_wrap(result);
+}
+
+static PyObject* PySparseTensor_to_coo(PySparseTensorObject* self, PyObject* Py_UNUSED(ignored)) {
+    if (!self->sparse) {
+        PyErr_SetString(PyExc_RuntimeError, "SparseTensor is not initialized");
+        return NULL;
+    }
+    SparseTensor* result = sparse_to_coo(self->sparse);
+    if (!result) {
+        PyErr_SetString(PyExc_RuntimeError, "Failed to convert to coo");
+        return NULL;
+    }
+    return PySparseTensor_wrap(result);
+}
+
+static PyObject* PySparseTensor_binary(PySparseTensorObject* self, PyObject* other,
+                                       SparseTensor* (*fn)(const SparseTensor*, const SparseTensor*)) {
+    if (!PyObject_IsInstance(other, (PyObject*)&PySparseTensorType)) {
+        PyErr_SetString(PyExc_TypeError, "Argument must be a SparseTensor object");
+        return NULL;
+    }
+
+    if (!self->sparse || !((PySparseTensorObject*)other)->sparse) {
+        PyErr_SetString(PyExc_RuntimeError, "SparseTensor is not initialized");
+        return NULL;
+    }
+
+    SparseTensor* result = fn(self->sparse, ((PySparseTensorObject*)other)->sparse);
+    if (!result) {
+        PyErr_SetString(PyExc_RuntimeError, "Sparse elementwise op failed");
+        return NULL;
+    }
+    return PySparseTensor_wrap(result);
+}
+
+static PyObject* PySparseTensor_add(PySparseTensorObject* self, PyObject* other) {
+    return PySparseTensor_binary(self, other, sparse_add);
+}
+
+static PyObject* PySparseTensor_mul(PySparseTensorObject* self, PyObject* other) {
+    return PySparseTensor_binary(self, other, sparse_mul);
+}
+
+static PyObject* PySparseTensor_repr(PySparseTensorObject* self) {
+    if (!self->sparse) {
+        return PyUnicode_FromString("SparseTensor([])");
+    }
+
+    char* s = sparse_to_string(self->sparse);
+    if (!s) {
+        return PyUnicode_FromString("SparseTensor(<error>)");
+    }
+    PyObject* repr = PyUnicode_FromString(s);
+    free(s);
+    return repr;
+}
+
+static PyMethodDef PySparseTensor_methods[] = {
+    {"shape", (PyCFunction)PySparseTensor_shape, METH_NOARGS, "Return the shape as a tuple"},
+    {"nnz", (PyCFunction)PySparseTensor_nnz, METH_NOARGS, "Return the number of stored values"},
+    {"layout", (PyCFunction)PySparseTensor_layout, METH_NOARGS, "Return 'coo' or 'csr'"},
+    {"to_dense", (PyCFunction)PySparseTensor_to_dense, METH_NOARGS, "Convert to a dense Tensor"},
+    {"to_csr", (PyCFunction)PySparseTensor_to_csr, METH_NOARGS, "Return a CSR copy"},
+    {"to_coo", (PyCFunction)PySparseTensor_to_coo, METH_NOARGS, "Return a COO copy"},
+    {"add", (PyCFunction)PySparseTensor_add, METH_O, "Elementwise sum over the union of both patterns"},
+    {"mul", (PyCFunction)PySparseTensor_mul, METH_O, "Elementwise product over the intersection of both patterns"},
+    {NULL}  // Sentinel
+};
+
+PyDoc_STRVAR(PySparseTensor__doc__,
+"SparseTensor(rows, cols, values, shape, dtype='float32', layout='coo')\n"
+"--\n\n"
+"A 2-D sparse matrix stored as COO or CSR. Duplicate coordinates are summed.\n"
+"\n"
+"Parameters\n"
+"----------\n"
+"rows, cols : list[int]\n"
+"    Row and column index of every stored value.\n"
+"values : list\n"
+"    The stored values, one per coordinate.\n"
+"shape : list[int]\n"
+"    The two dimensions of the matrix.\n"
+"dtype : str, optional\n"
+"    The data type ('float32', 'float64', 'int32', 'int64').\n"
+"layout : str, optional\n"
+"    The storage layout ('coo' or 'csr').\n"
+"\n"
+"Examples\n"
+"-------\n"
+">>> import smol_torch\n"
+">>> s = smol_torch.SparseTensor([0, 1], [2, 0], [1.0, 2.0], shape=[2, 3], layout='csr')\n"
+">>> s.nnz()\n"
+"2\n"
+">>> x = smol_torch.Tensor(data=[1, 2, 3], shape=[3])\n"
+">>> smol_torch.matmul(s, x).shape()\n"
+"(2,)\n");
+
+PyTypeObject PySparseTensorType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "smol_torch.SparseTensor",
+    .tp_doc = PySparseTensor__doc__,
+    .tp_basicsize = sizeof(PySparseTensorObject),
+    .tp_itemsize = 0,
+    .tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,
+    .tp_new = PySparseTensor_new,
+    .tp_init = (initproc)PySparseTensor_init,
+    .tp_dealloc = (destructor)PySparseTensor_dealloc,
+    .tp_repr = (reprfunc)PySparseTensor_repr,
+    .tp_methods = PySparseTensor_methods,
+};
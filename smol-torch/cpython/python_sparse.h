@@ -0,0 +1,18 @@
+#ifndef PYTHON_SPARSE_H
+#define PYTHON_SPARSE_H
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include "sparse.h"
+
+typedef struct {
+    PyObject_HEAD
+    SparseTensor* sparse;
+} PySparseTensorObject;
+
+extern PyTypeObject PySparseTensorType;
+
+int PySparseTensor_parse_layout(const char* layout_str, SparseLayout* layout);
+PyObject* PySparseTensor_wrap(SparseTensor* sparse);
+
+#endif // PYTHON_SPARSE_H
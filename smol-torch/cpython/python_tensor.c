@@ -4,6 +4,8 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "indexing.h"
+#include "random.h"
 #include "tensor.h"
 #include "python_tensor.h"
 
@@ -21,6 +23,81 @@ static PyObject* PyTensor_new(PyTypeObject* type, PyObject* args, PyObject* kwds
     return (PyObject*)self;
 }
 
+int PyTensor_parse_dtype(const char* dtype_str, Dtype* dtype) {
+    if (strcmp(dtype_str, "float32") == 0) {
+        *dtype = DTYPE_FLOAT32;
+    } else if (strcmp(dtype_str, "float64") == 0) {
+        *dtype = DTYPE_FLOAT64;
+    } else if (strcmp(dtype_str, "int32") == 0) {
+        *dtype = DTYPE_INT32;
+    } else if (strcmp(dtype_str, "int64") == 0) {
+        *dtype = DTYPE_INT64;
+    } else {
+        PyErr_SetString(PyExc_ValueError, "Unsupported dtype");
+        return -1;
+    }
+    return 0;
+}
+
+int64_t* PyTensor_parse_shape(PyObject* shape_list, int32_t* ndim_out) {
+    if (!PyList_Check(shape_list)) {
+        PyErr_SetString(PyExc_TypeError, "Shape must be a list of integers");
+        return NULL;
+    }
+
+    Py_ssize_t ndim = PyList_Size(shape_list);
+    if (ndim <= 0 || ndim > INT32_MAX) {
+        PyErr_SetString(PyExc_ValueError, "Invalid number of dimensions");
+        return NULL;
+    }
+
+    int64_t* shape = malloc(ndim * sizeof(int64_t));
+    if (!shape) {
+        PyErr_SetString(PyExc_RuntimeError, "Memory allocation failed");
+        return NULL;
+    }
+
+    for (Py_ssize_t i = 0; i < ndim; i++) {
+        PyObject* item = PyList_GetItem(shape_list, i);
+        if (!PyLong_Check(item)) {
+            free(shape);
+            PyErr_SetString(PyExc_TypeError, "Shape elements must be integers");
+            return NULL;
+        }
+        shape[i] = PyLong_AsLongLong(item);
+        if (shape[i] <= 0) {
+            free(shape);
+            PyErr_SetString(PyExc_ValueError, "Shape dimensions must be positive");
+            return NULL;
+        }
+    }
+
+    *ndim_out = (int32_t)ndim;
+    return shape;
+}
+
+PyObject* PyTensor_wrap(Tensor* tensor) {
+    PyTensorObject* out = PyObject_New(PyTensorObject, &PyTensorType);
+    if (!out) {
+        tensor_free(tensor);
+        return NULL;
+    }
+    out->tensor = tensor;
+    return (PyObject*)out;
+}
+
+Tensor* PyTensor_get(PyObject* obj) {
+    if (!PyObject_IsInstance(obj, (PyObject*)&PyTensorType)) {
+        PyErr_SetString(PyExc_TypeError, "Arguments must be Tensor objects");
+        return NULL;
+    }
+    Tensor* tensor = ((PyTensorObject*)obj)->tensor;
+    if (!tensor) {
+        PyErr_SetString(PyExc_RuntimeError, "Tensor is not initialized");
+    }
+    return tensor;
+}
+
 PyDoc_STRVAR(PyTensor_init__doc__,
 "Tensor(data=None, shape, dtype='float32')\n"
 "--\n\n"
@@ -62,53 +139,18 @@ static int PyTensor_init(PyTensorObject* self, PyObject* args, PyObject* kwds) {
     }
 
     // Parse dtype
-    Dtype dtype = DTYPE_FLOAT32;
-    if (strcmp(dtype_str, "float32") == 0) {
-        dtype = DTYPE_FLOAT32;
-    } else if (strcmp(dtype_str, "float64") == 0) {
-        dtype = DTYPE_FLOAT64;
-    } else if (strcmp(dtype_str, "int32") == 0) {
-        dtype = DTYPE_INT32;
-    } else if (strcmp(dtype_str, "int64") == 0) {
-        dtype = DTYPE_INT64;
-    } else {
-        PyErr_SetString(PyExc_ValueError, "Unsupported dtype");
+    Dtype dtype;
+    if (PyTensor_parse_dtype(dtype_str, &dtype) < 0) {
         return -1;
     }
 
     // Parse shape
-    if (!PyList_Check(shape_list)) {
-        PyErr_SetString(PyExc_TypeError, "Shape must be a list of integers");
-        return -1;
-    }
-
-    Py_ssize_t ndim = PyList_Size(shape_list);
-    if (ndim <= 0 || ndim > INT32_MAX) {
-        PyErr_SetString(PyExc_ValueError, "Invalid number of dimensions");
-        return -1;
-    }
-
-    int64_t* shape = malloc(ndim * sizeof(int64_t));
+    int32_t ndim;
+    int64_t* shape = PyTensor_parse_shape(shape_list, &ndim);
     if (!shape) {
-        PyErr_SetString(PyExc_RuntimeError, "Memory allocation failed");
         return -1;
     }
 
-    for (Py_ssize_t i = 0; i < ndim; i++) {
-        PyObject* item = PyList_GetItem(shape_list, i);
-        if (!PyLong_Check(item)) {
-            free(shape);
-            PyErr_SetString(PyExc_TypeError, "Shape elements must be integers");
-            return -1;
-        }
-        shape[i] = PyLong_AsLongLong(item);
-        if (shape[i] <= 0) {
-            free(shape);
-            PyErr_SetString(PyExc_ValueError, "Shape dimensions must be positive");
-            return -1;
-        }
-    }
-
     // Handle data
     if (data_list && data_list != Py_None) {
         if (!PyList_Check(data_list)) {
@@ -117,7 +159,7 @@ static int PyTensor_init(PyTensorObject* self, PyObject* args, PyObject* kwds) {
             return -1;
         }
 
-        int64_t expected_size = get_tensor_size(shape, (int32_t)ndim);
+        int64_t expected_size = get_tensor_size(shape, ndim);
         Py_ssize_t data_size = PyList_Size(data_list);
         if (data_size != expected_size) {
             free(shape);
@@ -162,11 +204,11 @@ static int PyTensor_init(PyTensorObject* self, PyObject* args, PyObject* kwds) {
             }
         }
 
-        self->tensor = create_tensor_with_data(data_buffer, shape, (int32_t)ndim, dtype);
+        self->tensor = create_tensor_with_data(data_buffer, shape, ndim, dtype);
         free(shape);
         free(data_buffer);
     } else {
-        self->tensor = create_tensor(shape, (int32_t)ndim, dtype);
+        self->tensor = create_tensor(shape, ndim, dtype);
         free(shape);
     }
 
@@ -202,6 +244,76 @@ static PyObject* PyTensor_shape(PyTensorObject* self, PyObject* Py_UNUSED(ignore
     return shape_tuple;
 }
 
+PyDoc_STRVAR(PyTensor_uniform___doc__,
+"uniform_(self, low=0.0, high=1.0)\n"
+"--\n\n"
+"Fill the tensor in place with samples from U(low, high) and return it.\n"
+"\n"
+"Examples\n"
+"--------\n"
+">>> import smol_torch\n"
+">>> smol_torch.manual_seed(0)\n"
+">>> t = smol_torch.Tensor(shape=[2, 3]).uniform_(-1.0, 1.0)\n");
+
+static PyObject* PyTensor_uniform_(PyTensorObject* self, PyObject* args, PyObject* kwds) {
+    double low = 0.0;
+    double high = 1.0;
+    static char* keywords[] = {"low", "high", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|dd", keywords, &low, &high)) {
+        return NULL;
+    }
+    if (!self->tensor) {
+        PyErr_SetString(PyExc_RuntimeError, "Tensor is not initialized");
+        return NULL;
+    }
+    if (self->tensor->dtype != DTYPE_FLOAT32 && self->tensor->dtype != DTYPE_FLOAT64) {
+        PyErr_Format(PyExc_TypeError, "uniform_ is not supported for dtype %s", dtype_name(self->tensor->dtype));
+        return NULL;
+    }
+
+    t_uniform(self->tensor, low, high);
+    Py_INCREF(self);
+    return (PyObject*)self;
+}
+
+PyDoc_STRVAR(PyTensor_normal___doc__,
+"normal_(self, mean=0.0, std=1.0)\n"
+"--\n\n"
+"Fill the tensor in place with samples from N(mean, std^2) and return it.\n"
+"\n"
+"Examples\n"
+"--------\n"
+">>> import smol_torch\n"
+">>> smol_torch.manual_seed(0)\n"
+">>> t = smol_torch.Tensor(shape=[2, 3]).normal_(0.0, 0.02)\n");
+
+static PyObject* PyTensor_normal_(PyTensorObject* self, PyObject* args, PyObject* kwds) {
+    double mean = 0.0;
+    double std = 1.0;
+    static char* keywords[] = {"mean", "std", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|dd", keywords, &mean, &std)) {
+        return NULL;
+    }
+    if (!self->tensor) {
+        PyErr_SetString(PyExc_RuntimeError, "Tensor is not initialized");
+        return NULL;
+    }
+    if (self->tensor->dtype != DTYPE_FLOAT32 && self->tensor->dtype != DTYPE_FLOAT64) {
+        PyErr_Format(PyExc_TypeError, "normal_ is not supported for dtype %s", dtype_name(self->tensor->dtype));
+        return NULL;
+    }
+    if (std < 0.0) {
+        PyErr_SetString(PyExc_ValueError, "std must be non-negative");
+        return NULL;
+    }
+
+    t_normal(self->tensor, mean, std);
+    Py_INCREF(self);
+    return (PyObject*)self;
+}
+
 static PyObject* PyTensor_repr(PyTensorObject* self) {
     if (!self->tensor) {
         return PyUnicode_FromString("Tensor([])");
@@ -216,12 +328,231 @@ static PyObject* PyTensor_repr(PyTensorObject* self) {
     return repr;
 }
 
+static PyObject* element_to_py(const Tensor* t, const int64_t i) {
+    switch (t->dtype) {
+        case DTYPE_FLOAT32: return PyFloat_FromDouble(((float*)t->data)[i]);
+        case DTYPE_FLOAT64: return PyFloat_FromDouble(((double*)t->data)[i]);
+        case DTYPE_INT32: return PyLong_FromLong(((int32_t*)t->data)[i]);
+        case DTYPE_INT64: return PyLong_FromLongLong(((int64_t*)t->data)[i]);
+        default:
+            PyErr_SetString(PyExc_TypeError, "Unsupported dtype");
+            return NULL;
+    }
+}
+
+// Fills one range per dimension from an int, a slice or a tuple of them.
+// Dimensions the key does not mention are taken whole.
+static int parse_ranges(const Tensor* t, PyObject* key, TensorRange* ranges) {
+    const Py_ssize_t n = PyTuple_Check(key) ? PyTuple_GET_SIZE(key) : 1;
+    if (n > t->ndim) {
+        PyErr_Format(PyExc_IndexError, "Too many indices for tensor of dimension %d", t->ndim);
+        return -1;
+    }
+
+    for (int32_t d = 0; d < t->ndim; d++) {
+        ranges[d] = (TensorRange){.start = 0, .step = 1, .length = t->shape[d], .squeeze = false};
+    }
+
+    for (Py_ssize_t d = 0; d < n; d++) {
+        PyObject* item = PyTuple_Check(key) ? PyTuple_GET_ITEM(key, d) : key;
+        if (PySlice_Check(item)) {
+            Py_ssize_t start, stop, step;
+            if (PySlice_Unpack(item, &start, &stop, &step) < 0) {
+                return -1;
+            }
+            const Py_ssize_t length = PySlice_AdjustIndices(t->shape[d], &start, &stop, step);
+            if (length == 0) {
+                PyErr_SetString(PyExc_IndexError, "Empty slices are not supported");
+                return -1;
+            }
+            ranges[d] = (TensorRange){.start = start, .step = step, .length = length, .squeeze = false};
+        } else if (PyIndex_Check(item)) {
+            Py_ssize_t i = PyNumber_AsSsize_t(item, PyExc_IndexError);
+            if (i == -1 && PyErr_Occurred()) {
+                return -1;
+            }
+            if (i < 0) i += t->shape[d];
+            if (i < 0 || i >= t->shape[d]) {
+                PyErr_Format(PyExc_IndexError, "Index out of range for dimension %zd with size %lld",
+                             d, (long long)t->shape[d]);
+                return -1;
+            }
+            ranges[d] = (TensorRange){.start = i, .step = 1, .length = 1, .squeeze = true};
+        } else {
+            PyErr_SetString(PyExc_TypeError, "Indices must be integers, slices or an index Tensor");
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static bool is_index_tensor(PyObject* obj) {
+    if (!PyObject_IsInstance(obj, (PyObject*)&PyTensorType)) return false;
+    const Dtype dtype = ((PyTensorObject*)obj)->tensor->dtype;
+    return dtype == DTYPE_INT32 || dtype == DTYPE_INT64;
+}
+
+static PyObject* PyTensor_getitem(PyTensorObject* self, PyObject* key) {
+    if (!self->tensor) {
+        PyErr_SetString(PyExc_RuntimeError, "Tensor is not initialized");
+        return NULL;
+    }
+
+    if (PyObject_IsInstance(key, (PyObject*)&PyTensorType)) {
+        if (!PyTensor_get(key)) {
+            return NULL;
+        }
+        if (!is_index_tensor(key)) {
+            PyErr_SetString(PyExc_TypeError, "Index tensors must be int32 or int64");
+            return NULL;
+        }
+        Tensor* result = index_select_tensor(self->tensor, 0, ((PyTensorObject*)key)->tensor);
+        if (!result) {
+            PyErr_SetString(PyExc_IndexError, "Invalid index tensor");
+            return NULL;
+        }
+        return PyTensor_wrap(result);
+    }
+
+    TensorRange* ranges = malloc(sizeof(TensorRange) * self->tensor->ndim);
+    if (!ranges) {
+        return PyErr_NoMemory();
+    }
+    if (parse_ranges(self->tensor, key, ranges) < 0) {
+        free(ranges);
+        return NULL;
+    }
+
+    bool scalar = true;
+    for (int32_t d = 0; d < self->tensor->ndim; d++) scalar = scalar && ranges[d].squeeze;
+
+    Tensor* result = slice_tensor(self->tensor, ranges);
+    free(ranges);
+    if (!result) {
+        PyErr_SetString(PyExc_RuntimeError, "Failed to index tensor");
+        return NULL;
+    }
+
+    if (scalar) {
+        PyObject* value = element_to_py(result, 0);
+        tensor_free(result);
+        return value;
+    }
+    return PyTensor_wrap(result);
+}
+
+static Tensor* scalar_tensor(PyObject* value, const Dtype dtype) {
+    const bool is_float = dtype == DTYPE_FLOAT32 || dtype == DTYPE_FLOAT64;
+    if (!PyLong_Check(value) && !(is_float && PyFloat_Check(value))) {
+        PyErr_Format(PyExc_TypeError, "Values for dtype %s must be %s", dtype_name(dtype),
+                     is_float ? "float, int or Tensor" : "int or Tensor");
+        return NULL;
+    }
+
+    double f = 0.0;
+    long long i = 0;
+    if (is_float) {
+        f = PyFloat_AsDouble(value);
+    } else {
+        i = PyLong_AsLongLong(value);
+    }
+    if (PyErr_Occurred()) {
+        return NULL;
+    }
+    if (dtype == DTYPE_INT32 && (i < INT32_MIN || i > INT32_MAX)) {
+        PyErr_SetString(PyExc_OverflowError, "Value out of range for int32");
+        return NULL;
+    }
+
+    int64_t one = 1;
+    Tensor* t = create_tensor_empty(&one, 1, dtype);
+    if (!t) {
+        PyErr_SetString(PyExc_RuntimeError, "Failed to create tensor");
+        return NULL;
+    }
+    switch (dtype) {
+        case DTYPE_FLOAT32: ((float*)t->data)[0] = (float)f; break;
+        case DTYPE_FLOAT64: ((double*)t->data)[0] = f; break;
+        case DTYPE_INT32: ((int32_t*)t->data)[0] = (int32_t)i; break;
+        case DTYPE_INT64: ((int64_t*)t->data)[0] = i; break;
+        default: break;
+    }
+    return t;
+}
+
+static int PyTensor_setitem(PyTensorObject* self, PyObject* key, PyObject* value) {
+    if (!self->tensor) {
+        PyErr_SetString(PyExc_RuntimeError, "Tensor is not initialized");
+        return -1;
+    }
+    if (!value) {
+        PyErr_SetString(PyExc_TypeError, "Tensor elements cannot be deleted");
+        return -1;
+    }
+
+    Tensor* src;
+    Tensor* owned = NULL;
+    if (PyObject_IsInstance(value, (PyObject*)&PyTensorType)) {
+        src = PyTensor_get(value);
+        if (!src) {
+            return -1;
+        }
+    } else {
+        owned = src = scalar_tensor(value, self->tensor->dtype);
+        if (!src) {
+            return -1;
+        }
+    }
+
+    int status;
+    if (PyObject_IsInstance(key, (PyObject*)&PyTensorType)) {
+        if (!PyTensor_get(key)) {
+            tensor_free(owned);
+            return -1;
+        }
+        if (!is_index_tensor(key)) {
+            tensor_free(owned);
+            PyErr_SetString(PyExc_TypeError, "Index tensors must be int32 or int64");
+            return -1;
+        }
+        status = t_index_copy(self->tensor, 0, ((PyTensorObject*)key)->tensor, src);
+    } else {
+        TensorRange* ranges = malloc(sizeof(TensorRange) * self->tensor->ndim);
+        if (!ranges) {
+            tensor_free(owned);
+            PyErr_NoMemory();
+            return -1;
+        }
+        if (parse_ranges(self->tensor, key, ranges) < 0) {
+            free(ranges);
+            tensor_free(owned);
+            return -1;
+        }
+        status = t_assign_slice(self->tensor, ranges, src);
+        free(ranges);
+    }
+    tensor_free(owned);
+
+    if (status < 0) {
+        PyErr_SetString(PyExc_ValueError, "Value does not match the indexed region");
+        return -1;
+    }
+    return 0;
+}
+
+static PyMappingMethods PyTensor_as_mapping = {
+    .mp_subscript = (binaryfunc)PyTensor_getitem,
+    .mp_ass_subscript = (objobjargproc)PyTensor_setitem,
+};
+
 static PyMemberDef PyTensor_members[] = {
     {NULL}  // Sentinel
 };
 
 static PyMethodDef PyTensor_methods[] = {
     {"shape", (PyCFunction)PyTensor_shape, METH_NOARGS, PyTensor_shape__doc__},
+    {"uniform_", (PyCFunction)PyTensor_uniform_, METH_VARARGS | METH_KEYWORDS, PyTensor_uniform___doc__},
+    {"normal_", (PyCFunction)PyTensor_normal_, METH_VARARGS | METH_KEYWORDS, PyTensor_normal___doc__},
     {NULL}  // Sentinel
 };
 
@@ -251,6 +582,7 @@ PyTypeObject PyTensorType = {
     .tp_init = (initproc)PyTensor_init,
     .tp_dealloc = (destructor)PyTensor_dealloc,
     .tp_repr = (reprfunc)PyTensor_repr,
+    .tp_as_mapping = &PyTensor_as_mapping,
     .tp_members = PyTensor_members,
     .tp_methods = PyTensor_methods,
 };
\ No newline at end of file
@@ -12,4 +12,11 @@ typedef struct {
 
 extern PyTypeObject PyTensorType;
 
+int PyTensor_parse_dtype(const char* dtype_str, Dtype* dtype);
+int64_t* PyTensor_parse_shape(PyObject* shape_list, int32_t* ndim);
+PyObject* PyTensor_wrap(Tensor* tensor);
+// The Tensor behind obj, or NULL with TypeError (not a Tensor) or
+// RuntimeError (never initialised) set.
+Tensor* PyTensor_get(PyObject* obj);
+
 #endif // PYTHON_TENSOR_H
@@ -0,0 +1,446 @@
+#include "dataloader.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Records ahead of the current one to prefetch when reading in shuffled order.
+#define PREFETCH_DISTANCE 8
+
+typedef enum {
+    SLOT_EMPTY,
+    SLOT_FILLING,
+    SLOT_READY
+} SlotState;
+
+typedef struct {
+    Tensor** tensors;
+    int64_t batch;
+    SlotState state;
+    bool failed;
+} LoaderSlot;
+
+struct DataLoader {
+    const uint8_t* data;
+    size_t data_size;
+    bool mapped;
+
+    LoaderColumn* columns;
+    int64_t* column_offsets;
+    int32_t num_columns;
+    int64_t record_size;
+    int64_t num_records;
+
+    DataLoaderOptions options;
+    int64_t num_batches;
+    int64_t* order;
+    uint64_t epoch;
+
+    LoaderSlot* slots;
+    pthread_t* workers;
+    int32_t num_running;
+    bool stop;
+    int64_t next_to_fill;
+    int64_t next_to_take;
+    pthread_mutex_t lock;
+    pthread_cond_t slot_ready;
+    pthread_cond_t slot_free;
+};
+
+static int map_binary(DataLoader* loader, const char* path) {
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Failed to open %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        fprintf(stderr, "Failed to stat %s: %s\n", path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    if (st.st_size == 0) {
+        fprintf(stderr, "%s is empty\n", path);
+        close(fd);
+        return -1;
+    }
+
+    void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        fprintf(stderr, "Failed to map %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    madvise(data, (size_t)st.st_size, loader->options.shuffle ? MADV_RANDOM : MADV_SEQUENTIAL);
+
+    loader->data = data;
+    loader->data_size = (size_t)st.st_size;
+    loader->mapped = true;
+    return 0;
+}
+
+static char* read_file(const char* path, size_t* size) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "Failed to open %s: %s\n", path, strerror(errno));
+        return NULL;
+    }
+
+    fseek(f, 0, SEEK_END);
+    const long len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    if (len < 0) {
+        fclose(f);
+        return NULL;
+    }
+
+    char* buf = malloc((size_t)len + 1);
+    if (!buf) {
+        fclose(f);
+        return NULL;
+    }
+    *size = fread(buf, 1, (size_t)len, f);
+    buf[*size] = '\0';
+    fclose(f);
+    return buf;
+}
+
+static int parse_csv_field(const char** cursor, const Dtype dtype, uint8_t* dst) {
+    // strtod and friends skip any whitespace, newlines included, so an empty
+    // trailing field would otherwise swallow the next row.
+    while (**cursor == ' ' || **cursor == '\t') (*cursor)++;
+    if (**cursor == ',' || **cursor == '\r' || **cursor == '\n' || **cursor == '\0') return -1;
+
+    char* end;
+    switch (dtype) {
+        case DTYPE_FLOAT32: { const float v = strtof(*cursor, &end); memcpy(dst, &v, sizeof(v)); break; }
+        case DTYPE_FLOAT64: { const double v = strtod(*cursor, &end); memcpy(dst, &v, sizeof(v)); break; }
+        case DTYPE_INT32: { const int32_t v = (int32_t)strtol(*cursor, &end, 10); memcpy(dst, &v, sizeof(v)); break; }
+        case DTYPE_INT64: { const int64_t v = strtoll(*cursor, &end, 10); memcpy(dst, &v, sizeof(v)); break; }
+        default: return -1;
+    }
+    if (end == *cursor) return -1;
+
+    while (*end == ' ' || *end == '\t' || *end == '\r') end++;
+    if (*end == ',') end++;
+    else if (*end != '\n' && *end != '\0') return -1;
+    *cursor = end;
+    return 0;
+}
+
+// Decodes the CSV straight into packed records, so batching afterwards is
+// the same memcpy path as for binary files.
+static int load_csv(DataLoader* loader, const char* path) {
+    size_t size;
+    char* text = read_file(path, &size);
+    if (!text) return -1;
+
+    int64_t lines = 0;
+    for (size_t i = 0; i < size; i++) lines += text[i] == '\n';
+    if (size > 0 && text[size - 1] != '\n') lines++;
+
+    uint8_t* records = malloc((size_t)loader->record_size * (lines > 0 ? lines : 1));
+    if (!records) {
+        free(text);
+        return -1;
+    }
+
+    const char* cursor = text;
+    int64_t line_no = 0;
+    int64_t n = 0;
+    while (*cursor) {
+        const char* line_end = strchr(cursor, '\n');
+        if (!line_end) line_end = cursor + strlen(cursor);
+        line_no++;
+
+        const char* p = cursor;
+        while (p < line_end && (*p == ' ' || *p == '\t' || *p == '\r')) p++;
+        const bool skip = p == line_end || (line_no == 1 && loader->options.csv_header);
+        if (!skip) {
+            uint8_t* rec = records + n * loader->record_size;
+            for (int32_t c = 0; c < loader->num_columns; c++) {
+                const int dtype_size = get_tensor_dtype_size(loader->columns[c].dtype);
+                for (int64_t k = 0; k < loader->columns[c].count; k++) {
+                    uint8_t* dst = rec + loader->column_offsets[c] + k * dtype_size;
+                    if (p >= line_end || parse_csv_field(&p, loader->columns[c].dtype, dst) < 0) {
+                        fprintf(stderr, "%s:%lld: malformed or short CSV row\n", path, (long long)line_no);
+                        free(records);
+                        free(text);
+                        return -1;
+                    }
+                }
+            }
+            if (p < line_end) {
+                fprintf(stderr, "%s:%lld: too many CSV fields\n", path, (long long)line_no);
+                free(records);
+                free(text);
+                return -1;
+            }
+            n++;
+        }
+        cursor = *line_end ? line_end + 1 : line_end;
+    }
+    free(text);
+
+    loader->data = records;
+    loader->data_size = (size_t)(n * loader->record_size);
+    loader->mapped = false;
+    return 0;
+}
+
+DataLoader* dataloader_open(const char* path, const LoaderColumn* columns, const int32_t num_columns,
+                            const DataLoaderOptions* options) {
+    if (!path || !columns || num_columns <= 0 || options->batch_size <= 0 ||
+        options->prefetch <= 0 || options->num_workers <= 0) {
+        return NULL;
+    }
+
+    DataLoader* loader = calloc(1, sizeof(DataLoader));
+    if (!loader) return NULL;
+    loader->options = *options;
+    loader->num_columns = num_columns;
+    pthread_mutex_init(&loader->lock, NULL);
+    pthread_cond_init(&loader->slot_ready, NULL);
+    pthread_cond_init(&loader->slot_free, NULL);
+
+    loader->columns = malloc(sizeof(LoaderColumn) * num_columns);
+    loader->column_offsets = malloc(sizeof(int64_t) * num_columns);
+    if (!loader->columns || !loader->column_offsets) goto error;
+    memcpy(loader->columns, columns, sizeof(LoaderColumn) * num_columns);
+
+    for (int32_t c = 0; c < num_columns; c++) {
+        const int dtype_size = get_tensor_dtype_size(columns[c].dtype);
+        if (dtype_size == 0 || columns[c].count <= 0) {
+            fprintf(stderr, "Invalid loader column %d\n", c);
+            goto error;
+        }
+        loader->column_offsets[c] = loader->record_size;
+        loader->record_size += dtype_size * columns[c].count;
+    }
+
+    if (options->format == LOADER_CSV) {
+        if (load_csv(loader, path) < 0) goto error;
+    } else {
+        if (map_binary(loader, path) < 0) goto error;
+        if (loader->data_size % (size_t)loader->record_size != 0) {
+            fprintf(stderr, "%s: size %zu is not a multiple of the record size %lld\n",
+                    path, loader->data_size, (long long)loader->record_size);
+            goto error;
+        }
+    }
+
+    loader->num_records = (int64_t)(loader->data_size / (size_t)loader->record_size);
+    loader->num_batches = options->drop_last
+        ? loader->num_records / options->batch_size
+        : (loader->num_records + options->batch_size - 1) / options->batch_size;
+
+    loader->order = malloc(sizeof(int64_t) * (loader->num_records > 0 ? loader->num_records : 1));
+    loader->slots = calloc(options->prefetch, sizeof(LoaderSlot));
+    loader->workers = calloc(options->num_workers, sizeof(pthread_t));
+    if (!loader->order || !loader->slots || !loader->workers) goto error;
+    for (int32_t s = 0; s < options->prefetch; s++) {
+        loader->slots[s].tensors = calloc(num_columns, sizeof(Tensor*));
+        if (!loader->slots[s].tensors) goto error;
+    }
+    return loader;
+
+error:
+    dataloader_free(loader);
+    return NULL;
+}
+
+int64_t dataloader_num_records(const DataLoader* loader) {
+    return loader->num_records;
+}
+
+int64_t dataloader_num_batches(const DataLoader* loader) {
+    return loader->num_batches;
+}
+
+static void free_slot_tensors(DataLoader* loader, LoaderSlot* slot) {
+    for (int32_t c = 0; c < loader->num_columns; c++) {
+        tensor_free(slot->tensors[c]);
+        slot->tensors[c] = NULL;
+    }
+}
+
+static void stop_workers(DataLoader* loader) {
+    if (loader->num_running == 0) return;
+
+    pthread_mutex_lock(&loader->lock);
+    loader->stop = true;
+    pthread_cond_broadcast(&loader->slot_free);
+    pthread_mutex_unlock(&loader->lock);
+
+    for (int32_t w = 0; w < loader->num_running; w++) {
+        pthread_join(loader->workers[w], NULL);
+    }
+    loader->num_running = 0;
+}
+
+void dataloader_free(DataLoader* loader) {
+    if (!loader) return;
+
+    stop_workers(loader);
+    pthread_mutex_destroy(&loader->lock);
+    pthread_cond_destroy(&loader->slot_ready);
+    pthread_cond_destroy(&loader->slot_free);
+
+    if (loader->slots) {
+        for (int32_t s = 0; s < loader->options.prefetch; s++) {
+            if (!loader->slots[s].tensors) continue;
+            free_slot_tensors(loader, &loader->slots[s]);
+            free(loader->slots[s].tensors);
+        }
+    }
+
+    if (loader->mapped) munmap((void*)loader->data, loader->data_size);
+    else free((void*)loader->data);
+
+    free(loader->columns);
+    free(loader->column_offsets);
+    free(loader->order);
+    free(loader->slots);
+    free(loader->workers);
+    free(loader);
+}
+
+static uint64_t splitmix64(uint64_t* state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static void shuffle_order(DataLoader* loader) {
+    for (int64_t i = 0; i < loader->num_records; i++) loader->order[i] = i;
+    if (!loader->options.shuffle) return;
+
+    uint64_t state = loader->options.seed ^ (loader->epoch * 0xD1B54A32D192ED03ULL);
+    for (int64_t i = loader->num_records - 1; i > 0; i--) {
+        const int64_t j = (int64_t)(splitmix64(&state) % (uint64_t)(i + 1));
+        const int64_t tmp = loader->order[i];
+        loader->order[i] = loader->order[j];
+        loader->order[j] = tmp;
+    }
+}
+
+static int fill_batch(DataLoader* loader, LoaderSlot* slot, const int64_t batch) {
+    const int64_t first = batch * loader->options.batch_size;
+    const int64_t remaining = loader->num_records - first;
+    const int64_t rows = remaining < loader->options.batch_size ? remaining : loader->options.batch_size;
+
+    for (int32_t c = 0; c < loader->num_columns; c++) {
+        int64_t shape[2] = {rows, loader->columns[c].count};
+        slot->tensors[c] = create_tensor_empty(shape, loader->columns[c].count == 1 ? 1 : 2, loader->columns[c].dtype);
+        if (!slot->tensors[c]) {
+            free_slot_tensors(loader, slot);
+            return -1;
+        }
+    }
+
+    const int64_t* order = loader->order + first;
+    for (int64_t i = 0; i < rows; i++) {
+        if (loader->options.shuffle && i + PREFETCH_DISTANCE < rows) {
+            __builtin_prefetch(loader->data + order[i + PREFETCH_DISTANCE] * loader->record_size);
+        }
+        const uint8_t* rec = loader->data + order[i] * loader->record_size;
+        for (int32_t c = 0; c < loader->num_columns; c++) {
+            const int64_t bytes = get_tensor_dtype_size(loader->columns[c].dtype) * loader->columns[c].count;
+            memcpy((uint8_t*)slot->tensors[c]->data + i * bytes, rec + loader->column_offsets[c], bytes);
+        }
+    }
+    return 0;
+}
+
+static void* worker_main(void* arg) {
+    DataLoader* loader = arg;
+
+    pthread_mutex_lock(&loader->lock);
+    for (;;) {
+        if (loader->stop || loader->next_to_fill >= loader->num_batches) break;
+
+        const int64_t batch = loader->next_to_fill;
+        LoaderSlot* slot = &loader->slots[batch % loader->options.prefetch];
+        if (slot->state != SLOT_EMPTY) {
+            pthread_cond_wait(&loader->slot_free, &loader->lock);
+            continue;
+        }
+
+        loader->next_to_fill++;
+        slot->state = SLOT_FILLING;
+        slot->batch = batch;
+        pthread_mutex_unlock(&loader->lock);
+
+        const bool failed = fill_batch(loader, slot, batch) < 0;
+
+        pthread_mutex_lock(&loader->lock);
+        slot->failed = failed;
+        slot->state = SLOT_READY;
+        pthread_cond_broadcast(&loader->slot_ready);
+    }
+    pthread_mutex_unlock(&loader->lock);
+    return NULL;
+}
+
+int dataloader_start_epoch(DataLoader* loader) {
+    stop_workers(loader);
+
+    for (int32_t s = 0; s < loader->options.prefetch; s++) {
+        free_slot_tensors(loader, &loader->slots[s]);
+        loader->slots[s].state = SLOT_EMPTY;
+        loader->slots[s].failed = false;
+    }
+
+    shuffle_order(loader);
+    loader->epoch++;
+    loader->stop = false;
+    loader->next_to_fill = 0;
+    loader->next_to_take = 0;
+
+    for (int32_t w = 0; w < loader->options.num_workers; w++) {
+        if (pthread_create(&loader->workers[w], NULL, worker_main, loader) != 0) {
+            fprintf(stderr, "Failed to start data loader worker\n");
+            stop_workers(loader);
+            return -1;
+        }
+        loader->num_running++;
+    }
+    return 0;
+}
+
+int dataloader_next(DataLoader* loader, Tensor** out) {
+    if (loader->epoch == 0 && dataloader_start_epoch(loader) < 0) return -1;
+    if (loader->num_running == 0) return loader->next_to_take >= loader->num_batches ? 0 : -1;
+
+    pthread_mutex_lock(&loader->lock);
+    if (loader->next_to_take >= loader->num_batches) {
+        pthread_mutex_unlock(&loader->lock);
+        return 0;
+    }
+
+    LoaderSlot* slot = &loader->slots[loader->next_to_take % loader->options.prefetch];
+    while (slot->state != SLOT_READY) {
+        pthread_cond_wait(&loader->slot_ready, &loader->lock);
+    }
+
+    const bool failed = slot->failed;
+    for (int32_t c = 0; c < loader->num_columns; c++) {
+        out[c] = slot->tensors[c];
+        slot->tensors[c] = NULL;
+    }
+    slot->state = SLOT_EMPTY;
+    slot->failed = false;
+    loader->next_to_take++;
+    pthread_cond_broadcast(&loader->slot_free);
+    pthread_mutex_unlock(&loader->lock);
+
+    return failed ? -1 : 1;
+}
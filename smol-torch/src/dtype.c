@@ -1,6 +1,8 @@
 #include "dtype.h"
 
 #include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 
 int get_tensor_dtype_size(const Dtype dtype) {
     switch (dtype) {
@@ -41,3 +43,46 @@ Dtype promote(const Dtype a, const Dtype b) {
     // fallback
     return DTYPE_FLOAT64;
 }
+
+// Small casts (scalars, index lists) stay on the calling thread.
+#define CAST_LOOP(TO_T, FROM_T)                                                \
+    _Pragma("omp parallel for simd schedule(static) if (n > 65536)")          \
+    for (int64_t i = 0; i < n; i++) ((TO_T *)dst)[i] = (TO_T)((const FROM_T *)src)[i];
+
+#define DEFINE_CAST_FROM(FROM_ENUM, FROM_T)                                    \
+  case FROM_ENUM:                                                              \
+    switch (to) {                                                              \
+      case DTYPE_FLOAT32: CAST_LOOP(float, FROM_T) break;                      \
+      case DTYPE_FLOAT64: CAST_LOOP(double, FROM_T) break;                     \
+      case DTYPE_INT32: CAST_LOOP(int32_t, FROM_T) break;                      \
+      case DTYPE_INT64: CAST_LOOP(int64_t, FROM_T) break;                      \
+      default: break;                                                          \
+    }                                                                          \
+    break;
+
+void dtype_cast(void* dst, const Dtype to, const void* src, const Dtype from, const int64_t n) {
+    if (from == to) {
+        memcpy(dst, src, get_tensor_dtype_size(to) * n);
+        return;
+    }
+
+    switch (from) {
+        DEFINE_CAST_FROM(DTYPE_FLOAT32, float)
+        DEFINE_CAST_FROM(DTYPE_FLOAT64, double)
+        DEFINE_CAST_FROM(DTYPE_INT32, int32_t)
+        DEFINE_CAST_FROM(DTYPE_INT64, int64_t)
+    default:
+        break;
+    }
+}
+
+const void* dtype_as(const void* src, const Dtype from, const Dtype to, const int64_t n, bool* owned) {
+    *owned = false;
+    if (from == to) return src;
+
+    void* dst = malloc(get_tensor_dtype_size(to) * (n > 0 ? n : 1));
+    if (!dst) return NULL;
+    dtype_cast(dst, to, src, from, n);
+    *owned = true;
+    return dst;
+}
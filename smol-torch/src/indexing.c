@@ -0,0 +1,495 @@
+#include "indexing.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Rows ahead of the current one to prefetch when reading at random indices.
+#define PREFETCH_DISTANCE 8
+
+// Columns handled by one scatter task, so a task writes contiguous chunks.
+#define SCATTER_BLOCK 64
+
+static bool is_index_dtype(const Dtype dtype) {
+    return dtype == DTYPE_INT32 || dtype == DTYPE_INT64;
+}
+
+static inline int64_t index_at(const Tensor* index, const int64_t i) {
+    return index->dtype == DTYPE_INT32 ? ((const int32_t*)index->data)[i] : ((const int64_t*)index->data)[i];
+}
+
+static int check_indices(const Tensor* index, const int64_t bound, const char* op) {
+    if (!is_index_dtype(index->dtype)) {
+        fprintf(stderr, "%s expects an int32 or int64 index, got %s\n", op, dtype_name(index->dtype));
+        return -1;
+    }
+    for (int64_t i = 0; i < index->size; i++) {
+        const int64_t v = index_at(index, i);
+        if (v < 0 || v >= bound) {
+            fprintf(stderr, "%s: index %" PRId64 " out of range for size %" PRId64 "\n", op, v, bound);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static bool check_dim(const Tensor* a, const int32_t dim, const char* op) {
+    if (dim < 0 || dim >= a->ndim) {
+        fprintf(stderr, "%s: dim %d out of range for %d dimensions\n", op, dim, a->ndim);
+        return false;
+    }
+    return true;
+}
+
+// Views shape as (outer, shape[dim], inner).
+static void split_at(const int64_t* shape, const int32_t ndim, const int32_t dim, int64_t* outer, int64_t* inner) {
+    *outer = 1;
+    *inner = 1;
+    for (int32_t d = 0; d < dim; d++) *outer *= shape[d];
+    for (int32_t d = dim + 1; d < ndim; d++) *inner *= shape[d];
+}
+
+// True when b has a's shape everywhere except possibly along dim.
+static bool same_shape_except(const Tensor* a, const Tensor* b, const int32_t dim) {
+    if (a->ndim != b->ndim) return false;
+    for (int32_t d = 0; d < a->ndim; d++) {
+        if (d != dim && a->shape[d] != b->shape[d]) return false;
+    }
+    return true;
+}
+
+static Tensor* create_resized(const Tensor* a, const int32_t dim, const int64_t size, const Dtype dtype) {
+    int64_t* shape = malloc(sizeof(int64_t) * a->ndim);
+    if (!shape) return NULL;
+    memcpy(shape, a->shape, sizeof(int64_t) * a->ndim);
+    shape[dim] = size;
+    Tensor* out = create_tensor(shape, a->ndim, dtype);
+    free(shape);
+    if (out) out->device = a->device;
+    return out;
+}
+
+Tensor* index_select_tensor(const Tensor* a, const int32_t dim, const Tensor* index) {
+    if (!check_dim(a, dim, "index_select")) return NULL;
+    if (index->ndim != 1) {
+        fprintf(stderr, "index_select expects a 1-D index\n");
+        return NULL;
+    }
+    if (check_indices(index, a->shape[dim], "index_select") < 0) return NULL;
+
+    Tensor* out = create_resized(a, dim, index->size, a->dtype);
+    if (!out) return NULL;
+
+    int64_t outer, inner;
+    split_at(a->shape, a->ndim, dim, &outer, &inner);
+    const int64_t n = index->size;
+    const int64_t src_dim = a->shape[dim];
+    const size_t row_bytes = (size_t)inner * get_tensor_dtype_size(a->dtype);
+    const char* src = a->data;
+    char* dst = out->data;
+
+    #pragma omp parallel for schedule(static)
+    for (int64_t r = 0; r < outer * n; r++) {
+        const int64_t o = r / n;
+        const int64_t j = r % n;
+        if (j + PREFETCH_DISTANCE < n) {
+            __builtin_prefetch(src + (o * src_dim + index_at(index, j + PREFETCH_DISTANCE)) * row_bytes);
+        }
+        memcpy(dst + r * row_bytes, src + (o * src_dim + index_at(index, j)) * row_bytes, row_bytes);
+    }
+    return out;
+}
+
+#define DEFINE_GATHER_OP(C_TYPE)                                               \
+  {                                                                            \
+    const C_TYPE *src = (const C_TYPE *)a->data;                               \
+    C_TYPE *dst = (C_TYPE *)out->data;                                         \
+    _Pragma("omp parallel for schedule(static)")                              \
+    for (int64_t r = 0; r < outer * n; r++) {                                  \
+      const int64_t o = r / n;                                                 \
+      for (int64_t k = 0; k < inner; k++) {                                    \
+        const int64_t i = index_at(index, r * inner + k);                      \
+        dst[r * inner + k] = src[(o * src_dim + i) * inner + k];               \
+      }                                                                        \
+    }                                                                          \
+  }
+
+Tensor* gather_tensor(const Tensor* a, const int32_t dim, const Tensor* index) {
+    if (!check_dim(a, dim, "gather")) return NULL;
+    if (!same_shape_except(a, index, dim)) {
+        fprintf(stderr, "gather expects an index with the input's shape outside dim %d\n", dim);
+        return NULL;
+    }
+    if (check_indices(index, a->shape[dim], "gather") < 0) return NULL;
+
+    Tensor* out = create_resized(a, dim, index->shape[dim], a->dtype);
+    if (!out) return NULL;
+
+    int64_t outer, inner;
+    split_at(a->shape, a->ndim, dim, &outer, &inner);
+    const int64_t n = index->shape[dim];
+    const int64_t src_dim = a->shape[dim];
+
+    // Gather only moves bits, so dispatch on element width rather than dtype.
+    if (get_tensor_dtype_size(a->dtype) == 4) DEFINE_GATHER_OP(uint32_t)
+    else DEFINE_GATHER_OP(uint64_t)
+    return out;
+}
+
+#ifdef _OPENMP
+#define SCATTER_THREAD_ID(tid) ((tid) = omp_get_thread_num())
+#else
+#define SCATTER_THREAD_ID(tid) ((void)(tid))
+#endif
+
+// Tasks own disjoint (outer, column block) slabs of a, so they never write
+// the same element. When there are too few slabs to occupy every thread,
+// the source rows are split over threads instead: if a is no larger than
+// src, each thread accumulates into a private copy of a and the copies are
+// summed in thread order, which keeps results independent of scheduling.
+// A larger a (an embedding table under a small batch) is updated in place
+// with atomic adds rather than paying for per-thread copies of it.
+#define DEFINE_SCATTER_ADD_OP(DTYPE_ENUM, C_TYPE)                              \
+  case DTYPE_ENUM: {                                                           \
+    C_TYPE *dst = (C_TYPE *)a->data;                                           \
+    const C_TYPE *src = (const C_TYPE *)src_data;                              \
+    if (tasks >= nthreads) {                                                   \
+      _Pragma("omp parallel for schedule(static)")                            \
+      for (int64_t t = 0; t < tasks; t++) {                                    \
+        const int64_t o = t / blocks;                                          \
+        const int64_t k0 = (t % blocks) * SCATTER_BLOCK;                       \
+        const int64_t k1 = k0 + SCATTER_BLOCK < inner ? k0 + SCATTER_BLOCK : inner; \
+        for (int64_t j = 0; j < n; j++) {                                      \
+          const int64_t r = (o * n + j) * inner;                               \
+          for (int64_t k = k0; k < k1; k++) {                                  \
+            dst[(o * dst_dim + index_at(index, r + k)) * inner + k] += src[r + k]; \
+          }                                                                    \
+        }                                                                      \
+      }                                                                        \
+      break;                                                                   \
+    }                                                                          \
+    C_TYPE *acc = a->size <= src_size ? calloc((size_t)nthreads * a->size, sizeof(C_TYPE)) : NULL; \
+    if (!acc) {                                                                \
+      _Pragma("omp parallel for schedule(static)")                            \
+      for (int64_t r = 0; r < outer * n; r++) {                                \
+        const int64_t o = r / n;                                               \
+        for (int64_t k = 0; k < inner; k++) {                                  \
+          C_TYPE *cell = &dst[(o * dst_dim + index_at(index, r * inner + k)) * inner + k]; \
+          _Pragma("omp atomic")                                               \
+          *cell += src[r * inner + k];                                         \
+        }                                                                      \
+      }                                                                        \
+      break;                                                                   \
+    }                                                                          \
+    _Pragma("omp parallel num_threads(nthreads)")                             \
+    {                                                                          \
+      int tid = 0;                                                             \
+      SCATTER_THREAD_ID(tid);                                                  \
+      C_TYPE *mine = acc + (size_t)tid * a->size;                              \
+      _Pragma("omp for schedule(static)")                                     \
+      for (int64_t r = 0; r < outer * n; r++) {                                \
+        const int64_t o = r / n;                                               \
+        for (int64_t k = 0; k < inner; k++) {                                  \
+          mine[(o * dst_dim + index_at(index, r * inner + k)) * inner + k] += src[r * inner + k]; \
+        }                                                                      \
+      }                                                                        \
+    }                                                                          \
+    _Pragma("omp parallel for schedule(static)")                              \
+    for (int64_t i = 0; i < a->size; i++) {                                    \
+      C_TYPE sum = dst[i];                                                     \
+      for (int t = 0; t < nthreads; t++) sum += acc[(size_t)t * a->size + i];  \
+      dst[i] = sum;                                                            \
+    }                                                                          \
+    free(acc);                                                                 \
+    break;                                                                     \
+  }
+
+int t_scatter_add(Tensor* a, const int32_t dim, const Tensor* index, const Tensor* src) {
+    if (!check_dim(a, dim, "scatter_add")) return -1;
+    if (!same_shape_except(a, src, dim) || !same_shape_except(src, index, -1)) {
+        fprintf(stderr, "scatter_add expects index and src of the same shape, matching the input outside dim %d\n", dim);
+        return -1;
+    }
+    if (check_indices(index, a->shape[dim], "scatter_add") < 0) return -1;
+
+    bool owned;
+    const void* src_data = dtype_as(src->data, src->dtype, a->dtype, src->size, &owned);
+    if (!src_data) return -1;
+
+    int64_t outer, inner;
+    split_at(a->shape, a->ndim, dim, &outer, &inner);
+    const int64_t n = src->shape[dim];
+    const int64_t dst_dim = a->shape[dim];
+    const int64_t src_size = src->size;
+    const int64_t blocks = (inner + SCATTER_BLOCK - 1) / SCATTER_BLOCK;
+    const int64_t tasks = outer * blocks;
+    int nthreads = 1;
+#ifdef _OPENMP
+    nthreads = omp_get_max_threads();
+#endif
+
+    switch (a->dtype) {
+        DEFINE_SCATTER_ADD_OP(DTYPE_FLOAT32, float)
+        DEFINE_SCATTER_ADD_OP(DTYPE_FLOAT64, double)
+        DEFINE_SCATTER_ADD_OP(DTYPE_INT32, int32_t)
+        DEFINE_SCATTER_ADD_OP(DTYPE_INT64, int64_t)
+    default:
+        fprintf(stderr, "Unsupported dtype for scatter_add: %s\n", dtype_name(a->dtype));
+        break;
+    }
+
+    if (owned) free((void*)src_data);
+    return 0;
+}
+
+Tensor* scatter_add_tensor(const Tensor* a, const int32_t dim, const Tensor* index, const Tensor* src) {
+    Tensor* out = create_tensor_with_data(a->data, a->shape, a->ndim, a->dtype);
+    if (!out) return NULL;
+    out->device = a->device;
+
+    if (t_scatter_add(out, dim, index, src) < 0) {
+        tensor_free(out);
+        return NULL;
+    }
+    return out;
+}
+
+int t_index_copy(Tensor* a, const int32_t dim, const Tensor* index, const Tensor* src) {
+    if (!check_dim(a, dim, "index_copy")) return -1;
+    if (index->ndim != 1) {
+        fprintf(stderr, "index_copy expects a 1-D index\n");
+        return -1;
+    }
+    const bool broadcast = src->size == 1;
+    if (!broadcast && (!same_shape_except(a, src, dim) || src->shape[dim] != index->size)) {
+        fprintf(stderr, "index_copy expects src to match the selected rows\n");
+        return -1;
+    }
+    if (check_indices(index, a->shape[dim], "index_copy") < 0) return -1;
+
+    bool owned;
+    const char* src_data = dtype_as(src->data, src->dtype, a->dtype, src->size, &owned);
+    if (!src_data) return -1;
+
+    int64_t outer, inner;
+    split_at(a->shape, a->ndim, dim, &outer, &inner);
+    const int64_t n = index->size;
+    const int64_t dst_dim = a->shape[dim];
+    const size_t esize = get_tensor_dtype_size(a->dtype);
+    const size_t row_bytes = (size_t)inner * esize;
+    char* dst = a->data;
+
+    // Rows of one outer slice are written in index order, so with repeated
+    // indices the last one wins.
+    #pragma omp parallel for schedule(static) if (outer > 1)
+    for (int64_t o = 0; o < outer; o++) {
+        for (int64_t j = 0; j < n; j++) {
+            char* row = dst + (o * dst_dim + index_at(index, j)) * row_bytes;
+            if (broadcast) {
+                for (int64_t k = 0; k < inner; k++) memcpy(row + k * esize, src_data, esize);
+            } else {
+                memcpy(row, src_data + (o * n + j) * row_bytes, row_bytes);
+            }
+        }
+    }
+
+    if (owned) free((void*)src_data);
+    return 0;
+}
+
+#define DEFINE_MASKED_SELECT_OP(C_TYPE)                                        \
+  {                                                                            \
+    const C_TYPE *src = (const C_TYPE *)a->data;                               \
+    C_TYPE *dst = (C_TYPE *)out->data;                                         \
+    int64_t k = 0;                                                             \
+    for (int64_t i = 0; i < a->size; i++) {                                    \
+      if (index_at(mask, i) != 0) dst[k++] = src[i];                           \
+    }                                                                          \
+  }
+
+Tensor* masked_select_tensor(const Tensor* a, const Tensor* mask) {
+    if (!is_index_dtype(mask->dtype) || !same_shape_except(a, mask, -1)) {
+        fprintf(stderr, "masked_select expects an int32 or int64 mask of the input's shape\n");
+        return NULL;
+    }
+
+    int64_t count = 0;
+    #pragma omp parallel for reduction(+ : count) schedule(static)
+    for (int64_t i = 0; i < mask->size; i++) count += index_at(mask, i) != 0;
+    if (count == 0) {
+        fprintf(stderr, "masked_select: mask selects no elements\n");
+        return NULL;
+    }
+
+    Tensor* out = create_tensor(&count, 1, a->dtype);
+    if (!out) return NULL;
+    out->device = a->device;
+
+    if (get_tensor_dtype_size(a->dtype) == 4) DEFINE_MASKED_SELECT_OP(uint32_t)
+    else DEFINE_MASKED_SELECT_OP(uint64_t)
+    return out;
+}
+
+#define DEFINE_EMBEDDING_BAG_OP(DTYPE_ENUM, C_TYPE)                            \
+  case DTYPE_ENUM: {                                                           \
+    const C_TYPE *w = (const C_TYPE *)weight->data;                            \
+    C_TYPE *out_data = (C_TYPE *)out->data;                                    \
+    _Pragma("omp parallel for schedule(dynamic, 16)")                         \
+    for (int64_t b = 0; b < bags; b++) {                                       \
+      const int64_t start = index_at(offsets, b);                              \
+      const int64_t end = b + 1 < bags ? index_at(offsets, b + 1) : n;         \
+      C_TYPE *acc = out_data + b * dim;                                        \
+      for (int64_t p = start; p < end; p++) {                                  \
+        if (p + PREFETCH_DISTANCE < n) {                                       \
+          __builtin_prefetch(w + index_at(indices, p + PREFETCH_DISTANCE) * dim); \
+        }                                                                      \
+        const C_TYPE *row = w + index_at(indices, p) * dim;                    \
+        for (int64_t k = 0; k < dim; k++) acc[k] += row[k];                    \
+      }                                                                        \
+      if (mode == EMBEDDING_BAG_MEAN && end > start) {                         \
+        const C_TYPE scale = (C_TYPE)1 / (C_TYPE)(end - start);                \
+        for (int64_t k = 0; k < dim; k++) acc[k] *= scale;                     \
+      }                                                                        \
+    }                                                                          \
+    break;                                                                     \
+  }
+
+Tensor* embedding_bag_tensor(const Tensor* weight, const Tensor* indices, const Tensor* offsets,
+                             const EmbeddingBagMode mode) {
+    if (weight->ndim != 2 || indices->ndim != 1 || offsets->ndim != 1) {
+        fprintf(stderr, "embedding_bag expects a 2-D weight and 1-D indices and offsets\n");
+        return NULL;
+    }
+    if (weight->dtype != DTYPE_FLOAT32 && weight->dtype != DTYPE_FLOAT64) {
+        fprintf(stderr, "Unsupported dtype for embedding_bag: %s\n", dtype_name(weight->dtype));
+        return NULL;
+    }
+    if (check_indices(indices, weight->shape[0], "embedding_bag") < 0) return NULL;
+    if (check_indices(offsets, indices->size + 1, "embedding_bag") < 0) return NULL;
+
+    const int64_t n = indices->size;
+    const int64_t bags = offsets->size;
+    const int64_t dim = weight->shape[1];
+    if (index_at(offsets, 0) != 0) {
+        fprintf(stderr, "embedding_bag: offsets must start at 0\n");
+        return NULL;
+    }
+    for (int64_t b = 1; b < bags; b++) {
+        if (index_at(offsets, b) < index_at(offsets, b - 1)) {
+            fprintf(stderr, "embedding_bag: offsets must be non-decreasing\n");
+            return NULL;
+        }
+    }
+
+    int64_t shape[2] = {bags, dim};
+    Tensor* out = create_tensor(shape, 2, weight->dtype);
+    if (!out) return NULL;
+    out->device = weight->device;
+
+    switch (weight->dtype) {
+        DEFINE_EMBEDDING_BAG_OP(DTYPE_FLOAT32, float)
+        DEFINE_EMBEDDING_BAG_OP(DTYPE_FLOAT64, double)
+    default:
+        break;
+    }
+    return out;
+}
+
+static bool check_ranges(const Tensor* a, const TensorRange* ranges) {
+    for (int32_t d = 0; d < a->ndim; d++) {
+        const TensorRange* r = &ranges[d];
+        const int64_t last = r->start + (r->length - 1) * r->step;
+        if (r->length <= 0 || r->start < 0 || r->start >= a->shape[d] || last < 0 || last >= a->shape[d] ||
+            (r->squeeze && r->length != 1)) {
+            fprintf(stderr, "Invalid range for dimension %d\n", d);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Walks the region row-major and copies between it and a contiguous buffer.
+// With broadcast, buf holds one element that is written to every position.
+static int copy_region(Tensor* a, const TensorRange* ranges, char* buf, const bool to_region, const bool broadcast) {
+    const int32_t ndim = a->ndim;
+    const size_t esize = get_tensor_dtype_size(a->dtype);
+    int64_t* counter = calloc(ndim, sizeof(int64_t));
+    if (!counter) return -1;
+
+    char* base = a->data;
+    const TensorRange* last = &ranges[ndim - 1];
+    const int64_t last_stride = a->strides[ndim - 1] * last->step;
+    int64_t pos = 0;
+    for (;;) {
+        int64_t offset = 0;
+        for (int32_t d = 0; d < ndim - 1; d++) {
+            offset += (ranges[d].start + counter[d] * ranges[d].step) * a->strides[d];
+        }
+        offset += last->start * a->strides[ndim - 1];
+
+        for (int64_t k = 0; k < last->length; k++) {
+            char* elem = base + (offset + k * last_stride) * esize;
+            const char* from = broadcast ? buf : buf + (pos + k) * esize;
+            if (to_region) memcpy(elem, from, esize);
+            else memcpy(buf + (pos + k) * esize, elem, esize);
+        }
+        pos += last->length;
+
+        int32_t d = ndim - 2;
+        while (d >= 0 && ++counter[d] == ranges[d].length) {
+            counter[d] = 0;
+            d--;
+        }
+        if (d < 0) break;
+    }
+
+    free(counter);
+    return 0;
+}
+
+Tensor* slice_tensor(const Tensor* a, const TensorRange* ranges) {
+    if (!check_ranges(a, ranges)) return NULL;
+
+    int64_t* shape = malloc(sizeof(int64_t) * a->ndim);
+    if (!shape) return NULL;
+    int32_t ndim = 0;
+    for (int32_t d = 0; d < a->ndim; d++) {
+        if (!ranges[d].squeeze) shape[ndim++] = ranges[d].length;
+    }
+    // There are no 0-d tensors, so a fully indexed element comes back as (1,).
+    if (ndim == 0) shape[ndim++] = 1;
+
+    Tensor* out = create_tensor(shape, ndim, a->dtype);
+    free(shape);
+    if (!out) return NULL;
+    out->device = a->device;
+
+    if (copy_region((Tensor*)a, ranges, out->data, false, false) < 0) {
+        tensor_free(out);
+        return NULL;
+    }
+    return out;
+}
+
+int t_assign_slice(Tensor* a, const TensorRange* ranges, const Tensor* src) {
+    if (!check_ranges(a, ranges)) return -1;
+
+    int64_t count = 1;
+    for (int32_t d = 0; d < a->ndim; d++) count *= ranges[d].length;
+    if (src->size != 1 && src->size != count) {
+        fprintf(stderr, "Cannot assign %" PRId64 " elements to a region of %" PRId64 "\n", src->size, count);
+        return -1;
+    }
+
+    bool owned;
+    const void* src_data = dtype_as(src->data, src->dtype, a->dtype, src->size, &owned);
+    if (!src_data) return -1;
+
+    const int status = copy_region(a, ranges, (char*)src_data, true, src->size == 1);
+    if (owned) free((void*)src_data);
+    return status;
+}
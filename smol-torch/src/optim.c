@@ -0,0 +1,238 @@
+#include "optim.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Elements per work item. Large enough to amortise scheduling, small enough
+// that a handful of big tensors still spread over every thread.
+#define OPTIM_CHUNK 65536
+
+typedef struct {
+    int32_t tensor;
+    int64_t start;
+    int64_t len;
+} OptimChunk;
+
+typedef struct {
+    double lr;
+    double beta1;
+    double beta2;
+    double eps;
+    double step_size;
+    double inv_sqrt_bc2;
+    double l2;
+    double decay;
+} AdamConsts;
+
+static bool same_shape(const Tensor* a, const Tensor* b) {
+    if (a->ndim != b->ndim) return false;
+    for (int32_t d = 0; d < a->ndim; d++) {
+        if (a->shape[d] != b->shape[d]) return false;
+    }
+    return true;
+}
+
+static Tensor* master_at(Tensor** masters, const int32_t i) {
+    return masters ? masters[i] : NULL;
+}
+
+static bool check_group(Tensor** params, Tensor** grads, Tensor** masters, Tensor** const* states,
+                        const int nstates, const int32_t n, const char* op) {
+    for (int32_t i = 0; i < n; i++) {
+        const Tensor* p = params[i];
+        const Tensor* g = grads[i];
+        const Tensor* master = master_at(masters, i);
+
+        if (p->dtype != DTYPE_FLOAT32 && p->dtype != DTYPE_FLOAT64) {
+            fprintf(stderr, "%s: parameter %d has unsupported dtype %s\n", op, i, dtype_name(p->dtype));
+            return false;
+        }
+        if (g->dtype != p->dtype || !same_shape(p, g)) {
+            fprintf(stderr, "%s: gradient %d does not match its parameter\n", op, i);
+            return false;
+        }
+        if (master && (p->dtype != DTYPE_FLOAT32 || master->dtype != DTYPE_FLOAT64 || !same_shape(p, master))) {
+            fprintf(stderr, "%s: master weight %d must be a float64 copy of a float32 parameter\n", op, i);
+            return false;
+        }
+
+        const Dtype state_dtype = master ? DTYPE_FLOAT64 : p->dtype;
+        for (int s = 0; s < nstates; s++) {
+            const Tensor* state = states[s][i];
+            if (state->dtype != state_dtype || !same_shape(p, state)) {
+                fprintf(stderr, "%s: state tensor %d does not match its parameter\n", op, i);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static OptimChunk* plan_chunks(Tensor** params, const int32_t n, int64_t* count) {
+    int64_t total = 0;
+    for (int32_t i = 0; i < n; i++) total += (params[i]->size + OPTIM_CHUNK - 1) / OPTIM_CHUNK;
+
+    OptimChunk* chunks = malloc(sizeof(OptimChunk) * (total > 0 ? total : 1));
+    if (!chunks) return NULL;
+
+    int64_t c = 0;
+    for (int32_t i = 0; i < n; i++) {
+        for (int64_t start = 0; start < params[i]->size; start += OPTIM_CHUNK) {
+            const int64_t left = params[i]->size - start;
+            chunks[c++] = (OptimChunk){.tensor = i, .start = start, .len = left < OPTIM_CHUNK ? left : OPTIM_CHUNK};
+        }
+    }
+    *count = total;
+    return chunks;
+}
+
+static void* chunk_ptr(const Tensor* t, const int64_t start) {
+    return t ? (char*)t->data + start * get_tensor_dtype_size(t->dtype) : NULL;
+}
+
+#define DEFINE_SGD_KERNEL(NAME, P_TYPE, C_TYPE, HAS_MASTER)                    \
+static void NAME(P_TYPE* p, const P_TYPE* g, C_TYPE* buf, C_TYPE* master,     \
+                 const int64_t n, const SgdOptions* o, const bool first) {     \
+    const C_TYPE lr = (C_TYPE)o->lr;                                           \
+    const C_TYPE mu = (C_TYPE)o->momentum;                                     \
+    const C_TYPE damp = (C_TYPE)(1.0 - o->dampening);                          \
+    const C_TYPE wd = (C_TYPE)o->weight_decay;                                 \
+    const bool use_momentum = o->momentum != 0.0;                              \
+    const bool nesterov = o->nesterov;                                         \
+    _Pragma("omp simd")                                                        \
+    for (int64_t i = 0; i < n; i++) {                                          \
+        C_TYPE w = HAS_MASTER ? master[i] : (C_TYPE)p[i];                      \
+        C_TYPE d = (C_TYPE)g[i] + wd * w;                                      \
+        if (use_momentum) {                                                    \
+            const C_TYPE b = first ? d : mu * buf[i] + damp * d;               \
+            buf[i] = b;                                                        \
+            d = nesterov ? d + mu * b : b;                                     \
+        }                                                                      \
+        w -= lr * d;                                                           \
+        if (HAS_MASTER) master[i] = w;                                         \
+        p[i] = (P_TYPE)w;                                                      \
+    }                                                                          \
+}
+
+DEFINE_SGD_KERNEL(sgd_f32, float, float, 0)
+DEFINE_SGD_KERNEL(sgd_f64, double, double, 0)
+DEFINE_SGD_KERNEL(sgd_f32_master, float, double, 1)
+
+#define DEFINE_ADAM_KERNEL(NAME, P_TYPE, C_TYPE, HAS_MASTER, SQRT)             \
+static void NAME(P_TYPE* p, const P_TYPE* g, C_TYPE* m, C_TYPE* v, C_TYPE* master, \
+                 const int64_t n, const AdamConsts* k) {                       \
+    const C_TYPE b1 = (C_TYPE)k->beta1;                                        \
+    const C_TYPE b2 = (C_TYPE)k->beta2;                                        \
+    const C_TYPE one_b1 = (C_TYPE)(1.0 - k->beta1);                            \
+    const C_TYPE one_b2 = (C_TYPE)(1.0 - k->beta2);                            \
+    const C_TYPE eps = (C_TYPE)k->eps;                                         \
+    const C_TYPE step_size = (C_TYPE)k->step_size;                             \
+    const C_TYPE inv_sqrt_bc2 = (C_TYPE)k->inv_sqrt_bc2;                       \
+    const C_TYPE l2 = (C_TYPE)k->l2;                                           \
+    const C_TYPE decay = (C_TYPE)k->decay;                                     \
+    _Pragma("omp simd")                                                        \
+    for (int64_t i = 0; i < n; i++) {                                          \
+        C_TYPE w = HAS_MASTER ? master[i] : (C_TYPE)p[i];                      \
+        const C_TYPE d = (C_TYPE)g[i] + l2 * w;                                \
+        const C_TYPE mi = b1 * m[i] + one_b1 * d;                              \
+        const C_TYPE vi = b2 * v[i] + one_b2 * d * d;                          \
+        m[i] = mi;                                                             \
+        v[i] = vi;                                                             \
+        w = w * decay - step_size * mi / (SQRT(vi) * inv_sqrt_bc2 + eps);      \
+        if (HAS_MASTER) master[i] = w;                                         \
+        p[i] = (P_TYPE)w;                                                      \
+    }                                                                          \
+}
+
+DEFINE_ADAM_KERNEL(adam_f32, float, float, 0, sqrtf)
+DEFINE_ADAM_KERNEL(adam_f64, double, double, 0, sqrt)
+DEFINE_ADAM_KERNEL(adam_f32_master, float, double, 1, sqrt)
+
+int sgd_step(Tensor** params, Tensor** grads, Tensor** momentum_buffers, Tensor** masters,
+             const int32_t n, const int64_t step, const SgdOptions* options) {
+    const bool use_momentum = options->momentum != 0.0;
+    if (use_momentum && !momentum_buffers) {
+        fprintf(stderr, "sgd_step: momentum buffers are required when momentum is set\n");
+        return -1;
+    }
+    Tensor** const states[] = {momentum_buffers};
+    if (!check_group(params, grads, masters, states, use_momentum ? 1 : 0, n, "sgd_step")) return -1;
+
+    int64_t nchunks;
+    OptimChunk* chunks = plan_chunks(params, n, &nchunks);
+    if (!chunks) return -1;
+    const bool first = step <= 1;
+
+    #pragma omp parallel for schedule(static)
+    for (int64_t c = 0; c < nchunks; c++) {
+        const OptimChunk* ch = &chunks[c];
+        const Tensor* p = params[ch->tensor];
+        const Tensor* master = master_at(masters, ch->tensor);
+        void* buf = use_momentum ? chunk_ptr(momentum_buffers[ch->tensor], ch->start) : NULL;
+
+        if (master) {
+            sgd_f32_master(chunk_ptr(p, ch->start), chunk_ptr(grads[ch->tensor], ch->start), buf,
+                           chunk_ptr(master, ch->start), ch->len, options, first);
+        } else if (p->dtype == DTYPE_FLOAT32) {
+            sgd_f32(chunk_ptr(p, ch->start), chunk_ptr(grads[ch->tensor], ch->start), buf, NULL,
+                    ch->len, options, first);
+        } else {
+            sgd_f64(chunk_ptr(p, ch->start), chunk_ptr(grads[ch->tensor], ch->start), buf, NULL,
+                    ch->len, options, first);
+        }
+    }
+
+    free(chunks);
+    return 0;
+}
+
+int adam_step(Tensor** params, Tensor** grads, Tensor** exp_avgs, Tensor** exp_avg_sqs, Tensor** masters,
+              const int32_t n, const int64_t step, const AdamOptions* options) {
+    if (step < 1) {
+        fprintf(stderr, "adam_step: step counts from 1\n");
+        return -1;
+    }
+    Tensor** const states[] = {exp_avgs, exp_avg_sqs};
+    if (!check_group(params, grads, masters, states, 2, n, "adam_step")) return -1;
+
+    int64_t nchunks;
+    OptimChunk* chunks = plan_chunks(params, n, &nchunks);
+    if (!chunks) return -1;
+
+    const double bc1 = 1.0 - pow(options->beta1, (double)step);
+    const double bc2 = 1.0 - pow(options->beta2, (double)step);
+    const bool decoupled = options->decoupled_weight_decay;
+    const AdamConsts k = {
+        .lr = options->lr,
+        .beta1 = options->beta1,
+        .beta2 = options->beta2,
+        .eps = options->eps,
+        .step_size = options->lr / bc1,
+        .inv_sqrt_bc2 = 1.0 / sqrt(bc2),
+        .l2 = decoupled ? 0.0 : options->weight_decay,
+        .decay = decoupled ? 1.0 - options->lr * options->weight_decay : 1.0,
+    };
+
+    #pragma omp parallel for schedule(static)
+    for (int64_t c = 0; c < nchunks; c++) {
+        const OptimChunk* ch = &chunks[c];
+        const int32_t i = ch->tensor;
+        const Tensor* p = params[i];
+        const Tensor* master = master_at(masters, i);
+
+        if (master) {
+            adam_f32_master(chunk_ptr(p, ch->start), chunk_ptr(grads[i], ch->start), chunk_ptr(exp_avgs[i], ch->start),
+                            chunk_ptr(exp_avg_sqs[i], ch->start), chunk_ptr(master, ch->start), ch->len, &k);
+        } else if (p->dtype == DTYPE_FLOAT32) {
+            adam_f32(chunk_ptr(p, ch->start), chunk_ptr(grads[i], ch->start), chunk_ptr(exp_avgs[i], ch->start),
+                     chunk_ptr(exp_avg_sqs[i], ch->start), NULL, ch->len, &k);
+        } else {
+            adam_f64(chunk_ptr(p, ch->start), chunk_ptr(grads[i], ch->start), chunk_ptr(exp_avgs[i], ch->start),
+                     chunk_ptr(exp_avg_sqs[i], ch->start), NULL, ch->len, &k);
+        }
+    }
+
+    free(chunks);
+    return 0;
+}
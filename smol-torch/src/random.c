@@ -0,0 +1,396 @@
+#include "random.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PHILOX_M0 0xD2511F53u
+#define PHILOX_M1 0xCD9E8D57u
+#define PHILOX_W0 0x9E3779B9u
+#define PHILOX_W1 0xBB67AE85u
+#define PHILOX_ROUNDS 10
+
+// Philox blocks generated per work item. One block is four 32-bit words,
+// i.e. four float32 or two float64 elements; randint draws twice the width,
+// so two int32 or one int64 element.
+#define RNG_CHUNK 256
+
+#define DEFAULT_SEED 67280421310721ULL
+
+static uint64_t rng_seed = DEFAULT_SEED;
+static uint64_t rng_offset = 0;
+
+void manual_seed(const uint64_t seed) {
+    rng_seed = seed;
+    rng_offset = 0;
+}
+
+uint64_t initial_seed(void) {
+    return rng_seed;
+}
+
+static uint64_t rng_reserve(const uint64_t nblocks) {
+    const uint64_t base = rng_offset;
+    rng_offset += nblocks;
+    return base;
+}
+
+// Fills bits[4 * i + w] with word w of block (base + i). The rounds run over
+// struct-of-arrays lanes so the 32x32->64 multiplies vectorise across blocks.
+static void philox_chunk(const uint64_t seed, const uint64_t base, const int64_t n, uint32_t* bits) {
+    uint32_t c0[RNG_CHUNK], c1[RNG_CHUNK], c2[RNG_CHUNK], c3[RNG_CHUNK];
+    for (int64_t i = 0; i < n; i++) {
+        const uint64_t ctr = base + (uint64_t)i;
+        c0[i] = (uint32_t)ctr;
+        c1[i] = (uint32_t)(ctr >> 32);
+        c2[i] = 0;
+        c3[i] = 0;
+    }
+
+    uint32_t k0 = (uint32_t)seed;
+    uint32_t k1 = (uint32_t)(seed >> 32);
+    for (int r = 0; r < PHILOX_ROUNDS; r++) {
+        for (int64_t i = 0; i < n; i++) {
+            const uint64_t p0 = (uint64_t)PHILOX_M0 * c0[i];
+            const uint64_t p1 = (uint64_t)PHILOX_M1 * c2[i];
+            const uint32_t n0 = (uint32_t)(p1 >> 32) ^ c1[i] ^ k0;
+            const uint32_t n2 = (uint32_t)(p0 >> 32) ^ c3[i] ^ k1;
+            c1[i] = (uint32_t)p1;
+            c3[i] = (uint32_t)p0;
+            c0[i] = n0;
+            c2[i] = n2;
+        }
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+
+    for (int64_t i = 0; i < n; i++) {
+        bits[4 * i + 0] = c0[i];
+        bits[4 * i + 1] = c1[i];
+        bits[4 * i + 2] = c2[i];
+        bits[4 * i + 3] = c3[i];
+    }
+}
+
+static inline uint64_t bits64(const uint32_t* bits, const int64_t k) {
+    return (uint64_t)bits[2 * k] | ((uint64_t)bits[2 * k + 1] << 32);
+}
+
+static inline float bits_to_float(const uint32_t x) {
+    return (float)(x >> 8) * 0x1.0p-24f;
+}
+
+static inline double bits_to_double(const uint64_t x) {
+    return (double)(x >> 11) * 0x1.0p-53;
+}
+
+typedef enum {
+    RNG_UNIFORM,
+    RNG_NORMAL,
+    RNG_RANDINT
+} RngKind;
+
+typedef struct {
+    RngKind kind;
+    double a;
+    double b;
+    int64_t low;
+    uint64_t range;
+} RngParams;
+
+typedef union {
+    float f;
+    uint32_t i;
+} F32Bits;
+
+typedef union {
+    double f;
+    uint64_t i;
+} F64Bits;
+
+// Branch-free log for positive normal x, written without libm calls so the
+// Box-Muller loop vectorises. x = m * 2^e with m in [sqrt(1/2), sqrt(2)),
+// and log(m) = 2 atanh(s) with s = (m - 1) / (m + 1), |s| < 0.172, summed
+// as an odd series far enough to reach the precision of the type.
+static inline float log_f32(const float x) {
+    F32Bits b = {.f = x};
+    int32_t e = (int32_t)(b.i >> 23) - 127;
+    b.i = (b.i & 0x007FFFFFu) | 0x3F800000u;
+    const bool big = b.f > 1.41421356f;
+    const float m = big ? 0.5f * b.f : b.f;
+    e = big ? e + 1 : e;
+    const float s = (m - 1.0f) / (m + 1.0f);
+    const float s2 = s * s;
+    const float series = 1.0f + s2 * (1.0f / 3 + s2 * (1.0f / 5 + s2 * (1.0f / 7 + s2 * (1.0f / 9))));
+    return (float)e * 0.693147180559945f + 2.0f * s * series;
+}
+
+static inline double log_f64(const double x) {
+    F64Bits b = {.f = x};
+    int64_t e = (int64_t)(b.i >> 52) - 1023;
+    b.i = (b.i & 0x000FFFFFFFFFFFFFull) | 0x3FF0000000000000ull;
+    const bool big = b.f > 1.4142135623730951;
+    const double m = big ? 0.5 * b.f : b.f;
+    e = big ? e + 1 : e;
+    const double s = (m - 1.0) / (m + 1.0);
+    const double s2 = s * s;
+    double series = 1.0 / 19;
+    for (int k = 17; k >= 1; k -= 2) series = 1.0 / k + s2 * series;
+    return (double)e * 0.6931471805599453 + 2.0 * s * series;
+}
+
+// sin and cos of 2 pi t for t in [0, 1). The quadrant is split off in
+// turns, which is exact, leaving |x| <= pi / 4 for the Taylor polynomials;
+// the quadrant then swaps and negates the pair without branches.
+#define DEFINE_SINCOS_TURNS(NAME, C_TYPE, SIN_POLY, COS_POLY)                   \
+static inline void NAME(const C_TYPE t, C_TYPE* sin_out, C_TYPE* cos_out) {    \
+    const int32_t q = (int32_t)((C_TYPE)4 * t + (C_TYPE)0.5);                  \
+    const C_TYPE x = (t - (C_TYPE)0.25 * (C_TYPE)q) * (C_TYPE)6.283185307179586; \
+    const C_TYPE x2 = x * x;                                                   \
+    const C_TYPE sn = x * (SIN_POLY);                                          \
+    const C_TYPE cs = COS_POLY;                                                \
+    const C_TYPE a = (q & 1) ? cs : sn;                                        \
+    const C_TYPE b = (q & 1) ? sn : cs;                                        \
+    *sin_out = (q & 2) ? -a : a;                                               \
+    *cos_out = ((q + 1) & 2) ? -b : b;                                         \
+}
+
+DEFINE_SINCOS_TURNS(sincos_turns_f32, float,
+    1.0f + x2 * (-1.0f / 6 + x2 * (1.0f / 120 + x2 * (-1.0f / 5040 + x2 * (1.0f / 362880)))),
+    1.0f + x2 * (-1.0f / 2 + x2 * (1.0f / 24 + x2 * (-1.0f / 720 + x2 * (1.0f / 40320
+        + x2 * (-1.0f / 3628800))))))
+DEFINE_SINCOS_TURNS(sincos_turns_f64, double,
+    1.0 + x2 * (-1.0 / 6 + x2 * (1.0 / 120 + x2 * (-1.0 / 5040 + x2 * (1.0 / 362880
+        + x2 * (-1.0 / 39916800 + x2 * (1.0 / 6227020800 + x2 * (-1.0 / 1307674368000
+        + x2 * (1.0 / 355687428096000)))))))),
+    1.0 + x2 * (-1.0 / 2 + x2 * (1.0 / 24 + x2 * (-1.0 / 720 + x2 * (1.0 / 40320
+        + x2 * (-1.0 / 3628800 + x2 * (1.0 / 479001600 + x2 * (-1.0 / 87178291200
+        + x2 * (1.0 / 20922789888000 + x2 * (-1.0 / 6402373705728000))))))))))
+
+// Uniforms for a whole chunk are produced first and then transformed in
+// pairs, so Box-Muller never straddles two chunks and the tail of the
+// tensor sees the same values as a longer tensor with the same seed.
+#define DEFINE_FLOAT_CHUNK(NAME, C_TYPE, TO_UNIFORM, PER_BLOCK, LOG, SQRT, SINCOS) \
+static void NAME(C_TYPE* dst, const int64_t count, const uint32_t* bits,             \
+                 const RngParams* p) {                                               \
+    C_TYPE u[RNG_CHUNK * PER_BLOCK];                                                 \
+    const int64_t n = (count + 1) & ~(int64_t)1;                                     \
+    for (int64_t k = 0; k < n; k++) u[k] = TO_UNIFORM;                               \
+    if (p->kind == RNG_UNIFORM) {                                                    \
+        const C_TYPE low = (C_TYPE)p->a;                                             \
+        const C_TYPE span = (C_TYPE)(p->b - p->a);                                   \
+        for (int64_t k = 0; k < count; k++) dst[k] = low + span * u[k];              \
+        return;                                                                      \
+    }                                                                                \
+    const C_TYPE mean = (C_TYPE)p->a;                                                \
+    const C_TYPE std = (C_TYPE)p->b;                                                 \
+    _Pragma("omp simd")                                                              \
+    for (int64_t k = 0; k < n; k += 2) {                                             \
+        const C_TYPE r = SQRT((C_TYPE)-2 * LOG((C_TYPE)1 - u[k]));                   \
+        C_TYPE sn, cs;                                                               \
+        SINCOS(u[k + 1], &sn, &cs);                                                  \
+        u[k] = r * cs;                                                               \
+        u[k + 1] = r * sn;                                                           \
+    }                                                                                \
+    for (int64_t k = 0; k < count; k++) dst[k] = mean + std * u[k];                  \
+}
+
+DEFINE_FLOAT_CHUNK(fill_chunk_f32, float, bits_to_float(bits[k]), 4, log_f32, sqrtf, sincos_turns_f32)
+DEFINE_FLOAT_CHUNK(fill_chunk_f64, double, bits_to_double(bits64(bits, k)), 2, log_f64, sqrt, sincos_turns_f64)
+
+// randint draws twice the output width per element and scales it into the
+// range with a widening multiply, which keeps the bias below 2^-32 even for
+// ranges close to 2^32 or 2^64 without rejection (and the counter per
+// element stays fixed).
+static void fill_chunk_i32(int32_t* dst, const int64_t count, const uint32_t* bits, const RngParams* p) {
+    for (int64_t k = 0; k < count; k++) {
+        const uint64_t v = (uint64_t)(((__uint128_t)bits64(bits, k) * p->range) >> 64);
+        dst[k] = (int32_t)(p->low + (int64_t)v);
+    }
+}
+
+static void fill_chunk_i64(int64_t* dst, const int64_t count, const uint32_t* bits, const RngParams* p) {
+    for (int64_t k = 0; k < count; k++) {
+        const __uint128_t lo = ((__uint128_t)bits64(bits, 2 * k) * p->range) >> 64;
+        const __uint128_t hi = (__uint128_t)bits64(bits, 2 * k + 1) * p->range + lo;
+        dst[k] = (int64_t)((uint64_t)p->low + (uint64_t)(hi >> 64));
+    }
+}
+
+static void rng_fill(Tensor* out, const RngParams* p) {
+    const int64_t draw_bytes = get_tensor_dtype_size(out->dtype) * (p->kind == RNG_RANDINT ? 2 : 1);
+    const int64_t per_block = 16 / draw_bytes;
+    const int64_t per_chunk = RNG_CHUNK * per_block;
+    const int64_t nblocks = (out->size + per_block - 1) / per_block;
+    const int64_t nchunks = (nblocks + RNG_CHUNK - 1) / RNG_CHUNK;
+    const uint64_t seed = rng_seed;
+    const uint64_t base = rng_reserve((uint64_t)nblocks);
+
+    #pragma omp parallel for schedule(static)
+    for (int64_t c = 0; c < nchunks; c++) {
+        uint32_t bits[4 * RNG_CHUNK];
+        const int64_t first = c * per_chunk;
+        const int64_t count = out->size - first < per_chunk ? out->size - first : per_chunk;
+        const int64_t blocks = (count + per_block - 1) / per_block;
+        philox_chunk(seed, base + (uint64_t)(c * RNG_CHUNK), blocks, bits);
+
+        switch (out->dtype) {
+            case DTYPE_FLOAT32: fill_chunk_f32((float*)out->data + first, count, bits, p); break;
+            case DTYPE_FLOAT64: fill_chunk_f64((double*)out->data + first, count, bits, p); break;
+            case DTYPE_INT32: fill_chunk_i32((int32_t*)out->data + first, count, bits, p); break;
+            case DTYPE_INT64: fill_chunk_i64((int64_t*)out->data + first, count, bits, p); break;
+            default: break;
+        }
+    }
+}
+
+static bool is_floating(const Dtype dtype) {
+    return dtype == DTYPE_FLOAT32 || dtype == DTYPE_FLOAT64;
+}
+
+void t_uniform(Tensor* out, const double low, const double high) {
+    if (!is_floating(out->dtype)) {
+        fprintf(stderr, "Unsupported dtype for uniform: %s\n", dtype_name(out->dtype));
+        return;
+    }
+    const RngParams p = {.kind = RNG_UNIFORM, .a = low, .b = high};
+    rng_fill(out, &p);
+}
+
+void t_normal(Tensor* out, const double mean, const double std) {
+    if (!is_floating(out->dtype)) {
+        fprintf(stderr, "Unsupported dtype for normal: %s\n", dtype_name(out->dtype));
+        return;
+    }
+    const RngParams p = {.kind = RNG_NORMAL, .a = mean, .b = std};
+    rng_fill(out, &p);
+}
+
+void t_randint(Tensor* out, const int64_t low, const int64_t high) {
+    if (!is_floating(out->dtype) && out->dtype != DTYPE_INT32 && out->dtype != DTYPE_INT64) {
+        fprintf(stderr, "Unsupported dtype for randint: %s\n", dtype_name(out->dtype));
+        return;
+    }
+    const RngParams p = {.kind = RNG_RANDINT, .low = low, .range = (uint64_t)high - (uint64_t)low};
+    if (is_floating(out->dtype)) {
+        // Draw as int64 and convert, so float outputs match int64 draws.
+        Tensor* tmp = create_tensor_empty(out->shape, out->ndim, DTYPE_INT64);
+        if (!tmp) return;
+        rng_fill(tmp, &p);
+        dtype_cast(out->data, out->dtype, tmp->data, DTYPE_INT64, out->size);
+        tensor_free(tmp);
+        return;
+    }
+    rng_fill(out, &p);
+}
+
+Tensor* rand_tensor(int64_t* shape, const int32_t ndim, const Dtype dtype) {
+    if (!is_floating(dtype)) {
+        fprintf(stderr, "rand expects a floating point dtype, got %s\n", dtype_name(dtype));
+        return NULL;
+    }
+    Tensor* out = create_tensor_empty(shape, ndim, dtype);
+    if (!out) return NULL;
+    t_uniform(out, 0.0, 1.0);
+    return out;
+}
+
+Tensor* randn_tensor(int64_t* shape, const int32_t ndim, const Dtype dtype) {
+    if (!is_floating(dtype)) {
+        fprintf(stderr, "randn expects a floating point dtype, got %s\n", dtype_name(dtype));
+        return NULL;
+    }
+    Tensor* out = create_tensor_empty(shape, ndim, dtype);
+    if (!out) return NULL;
+    t_normal(out, 0.0, 1.0);
+    return out;
+}
+
+Tensor* randint_tensor(const int64_t low, const int64_t high, int64_t* shape, const int32_t ndim, const Dtype dtype) {
+    if (high <= low) {
+        fprintf(stderr, "randint expects low < high\n");
+        return NULL;
+    }
+    if (dtype == DTYPE_INT32 && (low < INT32_MIN || high - 1 > INT32_MAX)) {
+        fprintf(stderr, "randint bounds out of range for int32\n");
+        return NULL;
+    }
+    Tensor* out = create_tensor_empty(shape, ndim, dtype);
+    if (!out) return NULL;
+    t_randint(out, low, high);
+    return out;
+}
+
+#define DEFINE_BERNOULLI_OP(DTYPE_ENUM, C_TYPE)                                \
+  case DTYPE_ENUM: {                                                           \
+    const C_TYPE *p_data = (const C_TYPE *)p->data;                            \
+    C_TYPE *out_data = (C_TYPE *)out->data;                                    \
+    _Pragma("omp parallel for simd schedule(static)")                         \
+    for (int64_t i = 0; i < out->size; i++) {                                  \
+      out_data[i] = out_data[i] < p_data[i] ? (C_TYPE)1 : (C_TYPE)0;           \
+    }                                                                          \
+    break;                                                                     \
+  }
+
+Tensor* bernoulli_tensor(const Tensor* p) {
+    if (!is_floating(p->dtype)) {
+        fprintf(stderr, "bernoulli expects a floating point tensor, got %s\n", dtype_name(p->dtype));
+        return NULL;
+    }
+    Tensor* out = create_tensor_empty(p->shape, p->ndim, p->dtype);
+    if (!out) return NULL;
+    t_uniform(out, 0.0, 1.0);
+
+    switch (p->dtype) {
+        DEFINE_BERNOULLI_OP(DTYPE_FLOAT32, float)
+        DEFINE_BERNOULLI_OP(DTYPE_FLOAT64, double)
+    default:
+        break;
+    }
+    out->device = p->device;
+    return out;
+}
+
+#define DEFINE_DROPOUT_OP(DTYPE_ENUM, C_TYPE)                                  \
+  case DTYPE_ENUM: {                                                           \
+    const C_TYPE *a_data = (const C_TYPE *)a->data;                            \
+    C_TYPE *out_data = (C_TYPE *)out->data;                                    \
+    const C_TYPE drop = (C_TYPE)p;                                             \
+    const C_TYPE scale = (C_TYPE)(1.0 / (1.0 - p));                            \
+    _Pragma("omp parallel for simd schedule(static)")                         \
+    for (int64_t i = 0; i < out->size; i++) {                                  \
+      out_data[i] = out_data[i] < drop ? (C_TYPE)0 : a_data[i] * scale;        \
+    }                                                                          \
+    break;                                                                     \
+  }
+
+Tensor* dropout_tensor(const Tensor* a, const double p, const bool training) {
+    if (!is_floating(a->dtype)) {
+        fprintf(stderr, "dropout expects a floating point tensor, got %s\n", dtype_name(a->dtype));
+        return NULL;
+    }
+    if (p < 0.0 || p > 1.0) {
+        fprintf(stderr, "dropout probability must be in [0, 1], got %f\n", p);
+        return NULL;
+    }
+
+    if (!training || p == 0.0) {
+        return create_tensor_with_data(a->data, a->shape, a->ndim, a->dtype);
+    }
+
+    Tensor* out = create_tensor(a->shape, a->ndim, a->dtype);
+    if (!out) return NULL;
+    out->device = a->device;
+    // create_tensor zero-fills, which is already the p == 1 result.
+    if (p == 1.0) return out;
+
+    t_uniform(out, 0.0, 1.0);
+    switch (a->dtype) {
+        DEFINE_DROPOUT_OP(DTYPE_FLOAT32, float)
+        DEFINE_DROPOUT_OP(DTYPE_FLOAT64, double)
+    default:
+        break;
+    }
+    return out;
+}
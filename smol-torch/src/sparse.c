@@ -0,0 +1,598 @@
+#include "sparse.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+static const char* layout_name(const SparseLayout layout) {
+    return layout == SPARSE_CSR ? "csr" : "coo";
+}
+
+static SparseTensor* sparse_alloc(const int64_t* shape, const int64_t nnz, const SparseLayout layout, const Dtype dtype) {
+    const int dtype_size = get_tensor_dtype_size(dtype);
+    if (dtype_size == 0 || shape[0] <= 0 || shape[1] <= 0 || nnz < 0) return NULL;
+
+    SparseTensor* s = calloc(1, sizeof(SparseTensor));
+    if (!s) return NULL;
+
+    s->shape[0] = shape[0];
+    s->shape[1] = shape[1];
+    s->nnz = nnz;
+    s->layout = layout;
+    s->dtype = dtype;
+    s->device = BACKEND_CPU;
+
+    // malloc(0) may legitimately return NULL, so always ask for one slot.
+    const int64_t slots = nnz > 0 ? nnz : 1;
+    s->values = malloc(dtype_size * slots);
+    s->col_indices = malloc(sizeof(int64_t) * slots);
+    if (layout == SPARSE_COO) {
+        s->row_indices = malloc(sizeof(int64_t) * slots);
+    } else {
+        s->row_ptr = calloc(shape[0] + 1, sizeof(int64_t));
+    }
+
+    if (!s->values || !s->col_indices || (!s->row_indices && !s->row_ptr)) {
+        sparse_free(s);
+        return NULL;
+    }
+    return s;
+}
+
+void sparse_free(SparseTensor* s) {
+    if (!s) return;
+    free(s->values);
+    free(s->row_indices);
+    free(s->row_ptr);
+    free(s->col_indices);
+    free(s);
+}
+
+typedef struct {
+    int64_t row;
+    int64_t col;
+    int64_t src;
+} CooEntry;
+
+static int coo_entry_cmp(const void* x, const void* y) {
+    const CooEntry* a = x;
+    const CooEntry* b = y;
+    if (a->row != b->row) return a->row < b->row ? -1 : 1;
+    if (a->col != b->col) return a->col < b->col ? -1 : 1;
+    return (a->src > b->src) - (a->src < b->src);
+}
+
+#define DEFINE_COALESCE_OP(DTYPE_ENUM, C_TYPE)                                 \
+  case DTYPE_ENUM: {                                                           \
+    const C_TYPE *src = (const C_TYPE *)values;                                \
+    C_TYPE *dst = (C_TYPE *)s->values;                                         \
+    int64_t k = -1;                                                            \
+    for (int64_t i = 0; i < nnz; i++) {                                        \
+      if (k < 0 || entries[i].row != s->row_indices[k] ||                      \
+          entries[i].col != s->col_indices[k]) {                               \
+        k++;                                                                   \
+        s->row_indices[k] = entries[i].row;                                    \
+        s->col_indices[k] = entries[i].col;                                    \
+        dst[k] = src[entries[i].src];                                          \
+      } else {                                                                 \
+        dst[k] += src[entries[i].src];                                         \
+      }                                                                        \
+    }                                                                          \
+    break;                                                                     \
+  }
+
+SparseTensor* create_sparse_coo(const int64_t* rows, const int64_t* cols, const void* values,
+                                const int64_t nnz, const int64_t* shape, const Dtype dtype) {
+    if (nnz < 0 || (nnz > 0 && (!rows || !cols || !values))) return NULL;
+
+    for (int64_t i = 0; i < nnz; i++) {
+        if (rows[i] < 0 || rows[i] >= shape[0] || cols[i] < 0 || cols[i] >= shape[1]) {
+            fprintf(stderr, "Sparse index (%" PRId64 ", %" PRId64 ") out of bounds\n", rows[i], cols[i]);
+            return NULL;
+        }
+    }
+
+    CooEntry* entries = malloc(sizeof(CooEntry) * (nnz > 0 ? nnz : 1));
+    if (!entries) return NULL;
+    for (int64_t i = 0; i < nnz; i++) {
+        entries[i].row = rows[i];
+        entries[i].col = cols[i];
+        entries[i].src = i;
+    }
+    qsort(entries, nnz, sizeof(CooEntry), coo_entry_cmp);
+
+    int64_t unique = 0;
+    for (int64_t i = 0; i < nnz; i++) {
+        if (i == 0 || entries[i].row != entries[i - 1].row || entries[i].col != entries[i - 1].col) unique++;
+    }
+
+    SparseTensor* s = sparse_alloc(shape, unique, SPARSE_COO, dtype);
+    if (!s) {
+        free(entries);
+        return NULL;
+    }
+
+    switch (dtype) {
+        DEFINE_COALESCE_OP(DTYPE_FLOAT32, float)
+        DEFINE_COALESCE_OP(DTYPE_FLOAT64, double)
+        DEFINE_COALESCE_OP(DTYPE_INT32, int32_t)
+        DEFINE_COALESCE_OP(DTYPE_INT64, int64_t)
+    default:
+        break;
+    }
+
+    free(entries);
+    return s;
+}
+
+static SparseTensor* sparse_clone(const SparseTensor* s) {
+    SparseTensor* out = sparse_alloc(s->shape, s->nnz, s->layout, s->dtype);
+    if (!out) return NULL;
+
+    memcpy(out->values, s->values, get_tensor_dtype_size(s->dtype) * s->nnz);
+    memcpy(out->col_indices, s->col_indices, sizeof(int64_t) * s->nnz);
+    if (s->layout == SPARSE_COO) {
+        memcpy(out->row_indices, s->row_indices, sizeof(int64_t) * s->nnz);
+    } else {
+        memcpy(out->row_ptr, s->row_ptr, sizeof(int64_t) * (s->shape[0] + 1));
+    }
+    out->device = s->device;
+    return out;
+}
+
+SparseTensor* sparse_to_csr(const SparseTensor* s) {
+    if (s->layout == SPARSE_CSR) return sparse_clone(s);
+
+    SparseTensor* out = sparse_alloc(s->shape, s->nnz, SPARSE_CSR, s->dtype);
+    if (!out) return NULL;
+
+    memcpy(out->values, s->values, get_tensor_dtype_size(s->dtype) * s->nnz);
+    memcpy(out->col_indices, s->col_indices, sizeof(int64_t) * s->nnz);
+    for (int64_t p = 0; p < s->nnz; p++) out->row_ptr[s->row_indices[p] + 1]++;
+    for (int64_t r = 0; r < s->shape[0]; r++) out->row_ptr[r + 1] += out->row_ptr[r];
+    out->device = s->device;
+    return out;
+}
+
+SparseTensor* sparse_to_coo(const SparseTensor* s) {
+    if (s->layout == SPARSE_COO) return sparse_clone(s);
+
+    SparseTensor* out = sparse_alloc(s->shape, s->nnz, SPARSE_COO, s->dtype);
+    if (!out) return NULL;
+
+    memcpy(out->values, s->values, get_tensor_dtype_size(s->dtype) * s->nnz);
+    memcpy(out->col_indices, s->col_indices, sizeof(int64_t) * s->nnz);
+    for (int64_t r = 0; r < s->shape[0]; r++) {
+        for (int64_t p = s->row_ptr[r]; p < s->row_ptr[r + 1]; p++) out->row_indices[p] = r;
+    }
+    out->device = s->device;
+    return out;
+}
+
+// Kernels work on CSR; a COO input is converted into *tmp, which the caller frees.
+static const SparseTensor* as_csr(const SparseTensor* s, SparseTensor** tmp) {
+    *tmp = NULL;
+    if (s->layout == SPARSE_CSR) return s;
+    *tmp = sparse_to_csr(s);
+    return *tmp;
+}
+
+#define DEFINE_COUNT_NONZERO_OP(DTYPE_ENUM, C_TYPE)                            \
+  case DTYPE_ENUM: {                                                           \
+    const C_TYPE *data = (const C_TYPE *)t->data;                              \
+    _Pragma("omp parallel for schedule(static)")                              \
+    for (int64_t r = 0; r < rows; r++) {                                       \
+      int64_t count = 0;                                                       \
+      for (int64_t c = 0; c < cols; c++) count += data[r * cols + c] != 0;     \
+      s_counts[r + 1] = count;                                                 \
+    }                                                                          \
+    break;                                                                     \
+  }
+
+#define DEFINE_GATHER_NONZERO_OP(DTYPE_ENUM, C_TYPE)                           \
+  case DTYPE_ENUM: {                                                           \
+    const C_TYPE *data = (const C_TYPE *)t->data;                              \
+    C_TYPE *values = (C_TYPE *)s->values;                                      \
+    _Pragma("omp parallel for schedule(static)")                              \
+    for (int64_t r = 0; r < rows; r++) {                                       \
+      int64_t k = s->row_ptr[r];                                               \
+      for (int64_t c = 0; c < cols; c++) {                                     \
+        const C_TYPE v = data[r * cols + c];                                   \
+        if (v != 0) {                                                          \
+          s->col_indices[k] = c;                                               \
+          values[k++] = v;                                                     \
+        }                                                                      \
+      }                                                                        \
+    }                                                                          \
+    break;                                                                     \
+  }
+
+SparseTensor* sparse_from_dense(const Tensor* t, const SparseLayout layout) {
+    if (t->ndim != 2) {
+        fprintf(stderr, "Sparse tensors must be 2-D, got %d dimensions\n", t->ndim);
+        return NULL;
+    }
+
+    const int64_t rows = t->shape[0];
+    const int64_t cols = t->shape[1];
+    int64_t* s_counts = calloc(rows + 1, sizeof(int64_t));
+    if (!s_counts) return NULL;
+
+    switch (t->dtype) {
+        DEFINE_COUNT_NONZERO_OP(DTYPE_FLOAT32, float)
+        DEFINE_COUNT_NONZERO_OP(DTYPE_FLOAT64, double)
+        DEFINE_COUNT_NONZERO_OP(DTYPE_INT32, int32_t)
+        DEFINE_COUNT_NONZERO_OP(DTYPE_INT64, int64_t)
+    default:
+        break;
+    }
+    for (int64_t r = 0; r < rows; r++) s_counts[r + 1] += s_counts[r];
+
+    SparseTensor* s = sparse_alloc(t->shape, s_counts[rows], SPARSE_CSR, t->dtype);
+    if (!s) {
+        free(s_counts);
+        return NULL;
+    }
+    memcpy(s->row_ptr, s_counts, sizeof(int64_t) * (rows + 1));
+    free(s_counts);
+    s->device = t->device;
+
+    switch (t->dtype) {
+        DEFINE_GATHER_NONZERO_OP(DTYPE_FLOAT32, float)
+        DEFINE_GATHER_NONZERO_OP(DTYPE_FLOAT64, double)
+        DEFINE_GATHER_NONZERO_OP(DTYPE_INT32, int32_t)
+        DEFINE_GATHER_NONZERO_OP(DTYPE_INT64, int64_t)
+    default:
+        break;
+    }
+
+    if (layout == SPARSE_CSR) return s;
+
+    SparseTensor* coo = sparse_to_coo(s);
+    sparse_free(s);
+    return coo;
+}
+
+Tensor* sparse_to_dense(const SparseTensor* s) {
+    int64_t shape[2] = {s->shape[0], s->shape[1]};
+    Tensor* out = create_tensor(shape, 2, s->dtype);
+    if (!out) return NULL;
+    out->device = s->device;
+
+    const int64_t cols = s->shape[1];
+    const int dtype_size = get_tensor_dtype_size(s->dtype);
+    char* dst = out->data;
+    const char* src = s->values;
+    if (s->layout == SPARSE_COO) {
+        for (int64_t p = 0; p < s->nnz; p++) {
+            memcpy(dst + (s->row_indices[p] * cols + s->col_indices[p]) * dtype_size,
+                   src + p * dtype_size, dtype_size);
+        }
+    } else {
+        #pragma omp parallel for schedule(static)
+        for (int64_t r = 0; r < s->shape[0]; r++) {
+            for (int64_t p = s->row_ptr[r]; p < s->row_ptr[r + 1]; p++) {
+                memcpy(dst + (r * cols + s->col_indices[p]) * dtype_size, src + p * dtype_size, dtype_size);
+            }
+        }
+    }
+    return out;
+}
+
+// Merge-path split (Merrill & Garland): the row end offsets and the nnz
+// positions are merged into one path of rows + nnz steps, which is cut into
+// equal pieces. Parts may start and end inside a row, so a single row that
+// holds most of the nnz is still spread over every thread, and empty rows
+// still count for something.
+typedef struct {
+    int64_t row;
+    int64_t nz;
+} MergeCoord;
+
+static MergeCoord* merge_path_split(const int64_t* row_ptr, const int64_t rows, int64_t* nparts_out) {
+    const int64_t nnz = row_ptr[rows];
+    const int64_t total = rows + nnz;
+    int64_t nparts = 1;
+#ifdef _OPENMP
+    nparts = (int64_t)omp_get_max_threads() * 4;
+#endif
+    if (nparts > total) nparts = total;
+
+    MergeCoord* coords = malloc(sizeof(MergeCoord) * (nparts + 1));
+    if (!coords) return NULL;
+
+    for (int64_t p = 0; p <= nparts; p++) {
+        const int64_t diag = total / nparts * p + total % nparts * p / nparts;
+        int64_t lo = diag > nnz ? diag - nnz : 0;
+        int64_t hi = diag < rows ? diag : rows;
+        while (lo < hi) {
+            const int64_t mid = lo + (hi - lo) / 2;
+            if (row_ptr[mid + 1] <= diag - 1 - mid) lo = mid + 1;
+            else hi = mid;
+        }
+        coords[p] = (MergeCoord){.row = lo, .nz = diag - lo};
+    }
+
+    *nparts_out = nparts;
+    return coords;
+}
+
+// Each part owns the rows that end inside it. The unfinished row it stops
+// in is summed into the part's carry row and added in after the loop, as
+// the parts before a row's owner may all hold pieces of it.
+#define DEFINE_SPMM_OP(DTYPE_ENUM, C_TYPE)                                     \
+  case DTYPE_ENUM: {                                                           \
+    const C_TYPE *a_data = (const C_TYPE *)a_vals;                             \
+    const C_TYPE *b_data = (const C_TYPE *)b_vals;                             \
+    C_TYPE *out_data = (C_TYPE *)out->data;                                    \
+    C_TYPE *carry_data = (C_TYPE *)carry;                                      \
+    const int64_t rows = csr->shape[0];                                        \
+    _Pragma("omp parallel for schedule(static)")                              \
+    for (int64_t part = 0; part < nparts; part++) {                            \
+      const MergeCoord end = coords[part + 1];                                 \
+      int64_t p = coords[part].nz;                                             \
+      for (int64_t r = coords[part].row; r <= end.row && r < rows; r++) {      \
+        const int64_t stop = r < end.row ? csr->row_ptr[r + 1] : end.nz;       \
+        C_TYPE *dst = r < end.row ? out_data + r * n : carry_data + part * n;  \
+        if (n == 1) {                                                          \
+          C_TYPE acc = 0;                                                      \
+          for (; p < stop; p++) acc += a_data[p] * b_data[csr->col_indices[p]]; \
+          dst[0] += acc;                                                       \
+          continue;                                                            \
+        }                                                                      \
+        for (; p < stop; p++) {                                                \
+          const C_TYPE v = a_data[p];                                          \
+          const C_TYPE *b_row = b_data + csr->col_indices[p] * n;              \
+          for (int64_t j = 0; j < n; j++) dst[j] += v * b_row[j];              \
+        }                                                                      \
+      }                                                                        \
+    }                                                                          \
+    for (int64_t part = 0; part < nparts; part++) {                            \
+      const int64_t r = coords[part + 1].row;                                  \
+      if (r == rows) continue;                                                 \
+      for (int64_t j = 0; j < n; j++) out_data[r * n + j] += carry_data[part * n + j]; \
+    }                                                                          \
+    break;                                                                     \
+  }
+
+Tensor* sparse_matmul(const SparseTensor* a, const Tensor* b) {
+    if ((b->ndim != 1 && b->ndim != 2) || b->shape[0] != a->shape[1]) {
+        fprintf(stderr, "Incompatible shapes for sparse matmul\n");
+        return NULL;
+    }
+
+    if (a->device != b->device) {
+        printf("Error: Tensors must be on same device\n");
+        return NULL;
+    }
+
+    const Dtype o_dtype = promote(a->dtype, b->dtype);
+    const int64_t n = b->ndim == 2 ? b->shape[1] : 1;
+    int64_t out_shape[2] = {a->shape[0], n};
+    Tensor* out = create_tensor(out_shape, b->ndim, o_dtype);
+    if (!out) return NULL;
+    out->device = a->device;
+
+    SparseTensor* tmp;
+    const SparseTensor* csr = as_csr(a, &tmp);
+    if (!csr) {
+        tensor_free(out);
+        return NULL;
+    }
+
+    bool a_owned, b_owned;
+    const void* a_vals = dtype_as(csr->values, csr->dtype, o_dtype, csr->nnz, &a_owned);
+    const void* b_vals = dtype_as(b->data, b->dtype, o_dtype, b->size, &b_owned);
+    int64_t nparts = 0;
+    MergeCoord* coords = merge_path_split(csr->row_ptr, csr->shape[0], &nparts);
+    void* carry = coords ? calloc(nparts * n, get_tensor_dtype_size(o_dtype)) : NULL;
+
+    if (!a_vals || !b_vals || !carry) {
+        tensor_free(out);
+        out = NULL;
+        goto cleanup;
+    }
+
+    switch (o_dtype) {
+        DEFINE_SPMM_OP(DTYPE_FLOAT32, float)
+        DEFINE_SPMM_OP(DTYPE_FLOAT64, double)
+        DEFINE_SPMM_OP(DTYPE_INT32, int32_t)
+        DEFINE_SPMM_OP(DTYPE_INT64, int64_t)
+    default:
+        fprintf(stderr, "Unsupported dtype for sparse matmul: %s\n", dtype_name(o_dtype));
+        break;
+    }
+
+cleanup:
+    if (a_owned) free((void*)a_vals);
+    if (b_owned) free((void*)b_vals);
+    free(coords);
+    free(carry);
+    sparse_free(tmp);
+    return out;
+}
+
+typedef enum {
+    SPARSE_OP_ADD,
+    SPARSE_OP_MUL
+} SparseOp;
+
+// Walks row r of a and b in column order. With out == NULL it only counts
+// the entries the result row will hold.
+#define DEFINE_MERGE_OP(DTYPE_ENUM, C_TYPE)                                    \
+  case DTYPE_ENUM: {                                                           \
+    const C_TYPE *a_data = (const C_TYPE *)a_vals;                             \
+    const C_TYPE *b_data = (const C_TYPE *)b_vals;                             \
+    C_TYPE *out_data = (C_TYPE *)out->values;                                  \
+    _Pragma("omp parallel for schedule(dynamic, 64)")                         \
+    for (int64_t r = 0; r < rows; r++) {                                       \
+      int64_t pa = A->row_ptr[r], pb = B->row_ptr[r], k = out->row_ptr[r];     \
+      const int64_t ea = A->row_ptr[r + 1], eb = B->row_ptr[r + 1];            \
+      while (pa < ea || pb < eb) {                                             \
+        const int64_t ca = pa < ea ? A->col_indices[pa] : INT64_MAX;           \
+        const int64_t cb = pb < eb ? B->col_indices[pb] : INT64_MAX;           \
+        if (ca == cb) {                                                        \
+          out->col_indices[k] = ca;                                            \
+          out_data[k++] = op == SPARSE_OP_ADD ? a_data[pa] + b_data[pb]        \
+                                              : a_data[pa] * b_data[pb];       \
+          pa++;                                                                \
+          pb++;                                                                \
+        } else if (ca < cb) {                                                  \
+          if (op == SPARSE_OP_ADD) {                                           \
+            out->col_indices[k] = ca;                                          \
+            out_data[k++] = a_data[pa];                                        \
+          }                                                                    \
+          pa++;                                                                \
+        } else {                                                               \
+          if (op == SPARSE_OP_ADD) {                                           \
+            out->col_indices[k] = cb;                                          \
+            out_data[k++] = b_data[pb];                                        \
+          }                                                                    \
+          pb++;                                                                \
+        }                                                                      \
+      }                                                                        \
+    }                                                                          \
+    break;                                                                     \
+  }
+
+#define DEFINE_PATTERN_OP(DTYPE_ENUM, C_TYPE)                                  \
+  case DTYPE_ENUM: {                                                           \
+    const C_TYPE *a_data = (const C_TYPE *)a_vals;                             \
+    const C_TYPE *b_data = (const C_TYPE *)b_vals;                             \
+    C_TYPE *out_data = (C_TYPE *)out->values;                                  \
+    if (op == SPARSE_OP_ADD) {                                                 \
+      _Pragma("omp parallel for simd schedule(static)")                       \
+      for (int64_t i = 0; i < out->nnz; i++) out_data[i] = a_data[i] + b_data[i]; \
+    } else {                                                                   \
+      _Pragma("omp parallel for simd schedule(static)")                       \
+      for (int64_t i = 0; i < out->nnz; i++) out_data[i] = a_data[i] * b_data[i]; \
+    }                                                                          \
+    break;                                                                     \
+  }
+
+static bool same_pattern(const SparseTensor* a, const SparseTensor* b) {
+    return a->nnz == b->nnz &&
+           memcmp(a->row_ptr, b->row_ptr, sizeof(int64_t) * (a->shape[0] + 1)) == 0 &&
+           memcmp(a->col_indices, b->col_indices, sizeof(int64_t) * a->nnz) == 0;
+}
+
+static int64_t merged_row_size(const SparseTensor* a, const SparseTensor* b, const int64_t r, const SparseOp op) {
+    int64_t pa = a->row_ptr[r], pb = b->row_ptr[r], count = 0;
+    const int64_t ea = a->row_ptr[r + 1], eb = b->row_ptr[r + 1];
+    while (pa < ea && pb < eb) {
+        const int64_t ca = a->col_indices[pa];
+        const int64_t cb = b->col_indices[pb];
+        if (ca == cb || op == SPARSE_OP_ADD) count++;
+        if (ca <= cb) pa++;
+        if (cb <= ca) pb++;
+    }
+    if (op == SPARSE_OP_ADD) count += (ea - pa) + (eb - pb);
+    return count;
+}
+
+static SparseTensor* sparse_binary(const SparseTensor* a, const SparseTensor* b, const SparseOp op) {
+    if (a->shape[0] != b->shape[0] || a->shape[1] != b->shape[1]) {
+        fprintf(stderr, "Incompatible shapes for sparse elementwise op\n");
+        return NULL;
+    }
+
+    if (a->device != b->device) {
+        printf("Error: Tensors must be on same device\n");
+        return NULL;
+    }
+
+    const Dtype o_dtype = promote(a->dtype, b->dtype);
+    const int64_t rows = a->shape[0];
+    SparseTensor *a_tmp, *b_tmp;
+    const SparseTensor* A = as_csr(a, &a_tmp);
+    const SparseTensor* B = as_csr(b, &b_tmp);
+    SparseTensor* out = NULL;
+    bool a_owned = false, b_owned = false;
+    const void* a_vals = NULL;
+    const void* b_vals = NULL;
+    if (!A || !B) goto cleanup;
+
+    a_vals = dtype_as(A->values, A->dtype, o_dtype, A->nnz, &a_owned);
+    b_vals = dtype_as(B->values, B->dtype, o_dtype, B->nnz, &b_owned);
+    if (!a_vals || !b_vals) goto cleanup;
+
+    if (same_pattern(A, B)) {
+        out = sparse_alloc(A->shape, A->nnz, SPARSE_CSR, o_dtype);
+        if (!out) goto cleanup;
+        memcpy(out->row_ptr, A->row_ptr, sizeof(int64_t) * (rows + 1));
+        memcpy(out->col_indices, A->col_indices, sizeof(int64_t) * A->nnz);
+
+        switch (o_dtype) {
+            DEFINE_PATTERN_OP(DTYPE_FLOAT32, float)
+            DEFINE_PATTERN_OP(DTYPE_FLOAT64, double)
+            DEFINE_PATTERN_OP(DTYPE_INT32, int32_t)
+            DEFINE_PATTERN_OP(DTYPE_INT64, int64_t)
+        default:
+            break;
+        }
+    } else {
+        int64_t* counts = calloc(rows + 1, sizeof(int64_t));
+        if (!counts) goto cleanup;
+        #pragma omp parallel for schedule(dynamic, 64)
+        for (int64_t r = 0; r < rows; r++) counts[r + 1] = merged_row_size(A, B, r, op);
+        for (int64_t r = 0; r < rows; r++) counts[r + 1] += counts[r];
+
+        out = sparse_alloc(A->shape, counts[rows], SPARSE_CSR, o_dtype);
+        if (!out) {
+            free(counts);
+            goto cleanup;
+        }
+        memcpy(out->row_ptr, counts, sizeof(int64_t) * (rows + 1));
+        free(counts);
+
+        switch (o_dtype) {
+            DEFINE_MERGE_OP(DTYPE_FLOAT32, float)
+            DEFINE_MERGE_OP(DTYPE_FLOAT64, double)
+            DEFINE_MERGE_OP(DTYPE_INT32, int32_t)
+            DEFINE_MERGE_OP(DTYPE_INT64, int64_t)
+        default:
+            break;
+        }
+    }
+    out->device = a->device;
+
+    if (a->layout == SPARSE_COO) {
+        SparseTensor* coo = sparse_to_coo(out);
+        sparse_free(out);
+        out = coo;
+    }
+
+cleanup:
+    if (a_owned) free((void*)a_vals);
+    if (b_owned) free((void*)b_vals);
+    sparse_free(a_tmp);
+    sparse_free(b_tmp);
+    return out;
+}
+
+SparseTensor* sparse_add(const SparseTensor* a, const SparseTensor* b) {
+    return sparse_binary(a, b, SPARSE_OP_ADD);
+}
+
+SparseTensor* sparse_mul(const SparseTensor* a, const SparseTensor* b) {
+    return sparse_binary(a, b, SPARSE_OP_MUL);
+}
+
+char* sparse_to_string(const SparseTensor* s) {
+    if (!s) return strdup("SparseTensor(NULL)");
+
+    const char* fmt = "SparseTensor(shape=(%" PRId64 ", %" PRId64 "), nnz=%" PRId64 ", layout=%s, dtype=%s)";
+    const int needed = snprintf(NULL, 0, fmt, s->shape[0], s->shape[1], s->nnz,
+                                layout_name(s->layout), dtype_name(s->dtype));
+    if (needed < 0) return NULL;
+
+    char* buf = malloc((size_t)needed + 1);
+    if (!buf) return NULL;
+    snprintf(buf, (size_t)needed + 1, fmt, s->shape[0], s->shape[1], s->nnz,
+             layout_name(s->layout), dtype_name(s->dtype));
+    return buf;
+}
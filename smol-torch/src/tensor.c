@@ -27,7 +27,7 @@ void get_tensor_strides(const int64_t* shape, int64_t* strides, const int32_t nd
     }
 }
 
-Tensor* create_tensor(int64_t* shape, int32_t ndim, Dtype dtype) {
+Tensor* create_tensor_empty(int64_t* shape, int32_t ndim, Dtype dtype) {
     if (ndim <= 0 || get_tensor_dtype_size(dtype) == 0) return NULL;
 
     Tensor* tensor = malloc(sizeof(Tensor));
@@ -69,15 +69,22 @@ Tensor* create_tensor(int64_t* shape, int32_t ndim, Dtype dtype) {
         free(tensor);
         return NULL;
     }
-    memset(tensor->data, 0, tensor->size * dtype_size);
 
     return tensor;
 }
 
+Tensor* create_tensor(int64_t* shape, int32_t ndim, Dtype dtype) {
+    Tensor* tensor = create_tensor_empty(shape, ndim, dtype);
+    if (!tensor) return NULL;
+
+    memset(tensor->data, 0, tensor->size * get_tensor_dtype_size(dtype));
+    return tensor;
+}
+
 Tensor* create_tensor_with_data(const void* data, int64_t* shape, int32_t ndim, Dtype dtype) {
     if (!data || ndim <= 0 || get_tensor_dtype_size(dtype) == 0) return NULL;
 
-    Tensor* tensor = create_tensor(shape, ndim, dtype);
+    Tensor* tensor = create_tensor_empty(shape, ndim, dtype);
     if (!tensor) return NULL;
 
     const int dtype_size = get_tensor_dtype_size(dtype);
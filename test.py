@@ -7,4 +7,148 @@ print(tensor)
 a = smol_torch.Tensor([1, 3], shape=[1, 2], dtype="int32")
 b = smol_torch.Tensor([2, 3], shape=[1, 2])
 c = smol_torch.add(a, b)
-print(c)
\ No newline at end of file
+print(c)
+# Philox4x32-10 known answer: key 0, counter 0 gives 0x6627e8d5 0xe169c58d
+# 0xbc57ac4c 0x9b00dbd8. float32 keeps the top 24 bits of each word; a
+# full-range int32 randint is the high word of each 64-bit pair.
+smol_torch.manual_seed(0)
+u = smol_torch.rand([4])
+assert [u[i] for i in range(4)] == [(w >> 8) / 2**24 for w in (0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8)]
+smol_torch.manual_seed(0)
+words = smol_torch.randint(-2**31, 2**31, [2], dtype="int32")
+assert [words[i] + 2**31 for i in range(2)] == [0xe169c58d, 0x9b00dbd8]
+
+# randint is uniform even when the range is a large fraction of 2^32 / 2^64.
+for low, high, dtype in ((-2**31, 2**30, "int32"), (-2**63, 2**62, "int64")):
+    n = 30000
+    t = smol_torch.randint(low, high, [n], dtype=dtype)
+    cut = low + (high - low) // 3
+    frac = sum(t[i] < cut for i in range(n)) / n
+    assert abs(frac - 1 / 3) < 0.02, (dtype, frac)
+
+# The same seed gives the same normals whatever the thread count.
+import os, subprocess, sys
+script = "import smol_torch; smol_torch.manual_seed(7); t = smol_torch.randn([100003]); print([t[i] for i in range(0, 100003, 997)])"
+outputs = [
+    subprocess.run([sys.executable, "-c", script], env=dict(os.environ, OMP_NUM_THREADS=n),
+                   capture_output=True, text=True, check=True).stdout
+    for n in ("1", "4")
+]
+assert outputs[0] == outputs[1]
+print("random ok")
+
+# scatter_add into a table larger than src (the embedding-gradient case),
+# with repeated indices, on one thread and on several.
+script = """import smol_torch
+V, B, D = 50, 3, 8
+rows = [7, 42, 7]
+table = smol_torch.Tensor(data=[1.0] * (V * D), shape=[V, D])
+idx = smol_torch.Tensor(data=[r for r in rows for _ in range(D)], shape=[B, D], dtype="int64")
+src = smol_torch.Tensor(data=[float(b * D + k) for b in range(B) for k in range(D)], shape=[B, D])
+out = smol_torch.scatter_add(table, 0, idx, src)
+print([out[v, k] for v in range(V) for k in range(D)])"""
+expected = [1.0] * (50 * 8)
+for b, r in enumerate([7, 42, 7]):
+    for k in range(8):
+        expected[r * 8 + k] += b * 8 + k
+for n in ("1", "4"):
+    out = subprocess.run([sys.executable, "-c", script], env=dict(os.environ, OMP_NUM_THREADS=n),
+                         capture_output=True, text=True, check=True).stdout
+    assert eval(out) == expected
+print("scatter_add ok")
+
+# SpMM / SpMV against a dense reference on a matrix with one dominant row,
+# so the merge-path split lands inside that row on several threads.
+script = """import smol_torch
+R, C, N = 40, 120, 3
+A = [float((r * C + c) % 7 - 3) if r == 5 or (r * C + c) % 53 == 0 else 0.0 for r in range(R) for c in range(C)]
+B = [float((c * N + j) % 5 - 2) for c in range(C) for j in range(N)]
+a = smol_torch.Tensor(data=A, shape=[R, C], dtype="float64")
+b = smol_torch.Tensor(data=B, shape=[C, N], dtype="float64")
+v = smol_torch.Tensor(data=B[:C], shape=[C], dtype="float64")
+res = []
+for layout in ("csr", "coo"):
+    s = smol_torch.to_sparse(a, layout=layout)
+    mm, mv = smol_torch.matmul(s, b), smol_torch.matmul(s, v)
+    res.append(([mm[r, j] for r in range(R) for j in range(N)], [mv[r] for r in range(R)]))
+print(res)"""
+R, C, N = 40, 120, 3
+A = [float((r * C + c) % 7 - 3) if r == 5 or (r * C + c) % 53 == 0 else 0.0 for r in range(R) for c in range(C)]
+B = [float((c * N + j) % 5 - 2) for c in range(C) for j in range(N)]
+mm = [sum(A[r * C + c] * B[c * N + j] for c in range(C)) for r in range(R) for j in range(N)]
+mv = [sum(A[r * C + c] * B[c] for c in range(C)) for r in range(R)]
+for n in ("1", "4"):
+    out = subprocess.run([sys.executable, "-c", script], env=dict(os.environ, OMP_NUM_THREADS=n),
+                         capture_output=True, text=True, check=True).stdout
+    assert eval(out) == [(mm, mv), (mm, mv)]
+print("sparse ok")
+
+# DataLoader: every record comes back exactly once per shuffled epoch, from
+# a packed binary file and from the same records written as CSV.
+import struct, tempfile
+with tempfile.TemporaryDirectory() as tmp:
+    n = 103
+    with open(os.path.join(tmp, "data.bin"), "wb") as f:
+        for i in range(n):
+            f.write(struct.pack("=3fq", i, i + 0.5, -i, i))
+    with open(os.path.join(tmp, "data.csv"), "w") as f:
+        f.write("a,b,c,label\n")
+        for i in range(n):
+            f.write(f"{i},{i + 0.5},{-i},{i}\n")
+    for name, kwargs in (("data.bin", {}), ("data.csv", {"format": "csv", "header": True})):
+        loader = smol_torch.DataLoader(os.path.join(tmp, name), [("float32", 3), ("int64", 1)],
+                                       batch_size=10, shuffle=True, seed=3, **kwargs)
+        assert loader.num_records() == n and len(loader) == 11
+        for epoch in range(2):
+            seen = []
+            for x, y in loader:
+                for i in range(y.shape()[0]):
+                    assert [x[i, 0], x[i, 1], x[i, 2]] == [y[i], y[i] + 0.5, -y[i]]
+                    seen.append(y[i])
+            assert sorted(seen) == list(range(n)) and seen != list(range(n))
+print("dataloader ok")
+
+# Indexing: gather, scatter_add with repeated indices along the last dim,
+# negative-step slices on both sides of an assignment, and an empty bag.
+a = smol_torch.Tensor(data=[float(i) for i in range(12)], shape=[3, 4])
+g = smol_torch.gather(a, 1, smol_torch.Tensor(data=[3, 0, 1, 1, 2, 2], shape=[3, 2], dtype="int64"))
+assert [g[i, j] for i in range(3) for j in range(2)] == [3.0, 0.0, 5.0, 5.0, 10.0, 10.0]
+out = smol_torch.scatter_add(smol_torch.Tensor(data=[0.0] * 6, shape=[2, 3]), 1,
+                             smol_torch.Tensor(data=[2, 2, 0, 1, 1, 1], shape=[2, 3], dtype="int64"),
+                             smol_torch.Tensor(data=[1.0, 2.0, 3.0, 4.0, 5.0, 6.0], shape=[2, 3]))
+assert [out[i, j] for i in range(2) for j in range(3)] == [3.0, 0.0, 3.0, 0.0, 15.0, 0.0]
+s = a[::-1, 3:0:-2]
+assert s.shape() == (3, 2) and [s[i, j] for i in range(3) for j in range(2)] == [11.0, 9.0, 7.0, 5.0, 3.0, 1.0]
+v = smol_torch.Tensor(data=[float(i) for i in range(6)], shape=[6])
+v[::-2] = smol_torch.Tensor(data=[10.0, 20.0, 30.0], shape=[3])
+v[4:0:-3] = 7.0
+assert [v[i] for i in range(6)] == [0.0, 7.0, 2.0, 20.0, 7.0, 10.0]
+w = smol_torch.Tensor(data=[float(i) for i in range(8)], shape=[4, 2])
+ids = smol_torch.Tensor(data=[1, 3, 2], shape=[3], dtype="int64")
+for mode, offsets, expected in (("mean", [0, 2, 2], [4.0, 5.0, 0.0, 0.0, 4.0, 5.0]),
+                                ("sum", [0, 0, 2], [0.0, 0.0, 8.0, 10.0, 4.0, 5.0])):
+    e = smol_torch.embedding_bag(w, ids, smol_torch.Tensor(data=offsets, shape=[3], dtype="int64"), mode=mode)
+    assert [e[i, j] for i in range(3) for j in range(2)] == expected
+print("indexing ok")
+
+# One optimizer step against the closed-form update. On step 1 Adam's bias
+# corrections cancel, so the step is lr * d / (|d| + eps).
+import math
+w0 = [0.5, -1.0, 2.0, 0.1]
+g0 = [0.2, -0.4, 0.0, 1.5]
+wd = 0.1
+cases = (
+    (lambda p: smol_torch.SGD(p, lr=0.1, momentum=0.9, weight_decay=wd),
+     [w - 0.1 * (g + wd * w) for w, g in zip(w0, g0)]),
+    (lambda p: smol_torch.Adam(p, lr=1e-2, weight_decay=wd),
+     [w - 1e-2 * (g + wd * w) / (abs(g + wd * w) + 1e-8) for w, g in zip(w0, g0)]),
+    (lambda p: smol_torch.AdamW(p, lr=1e-2, weight_decay=wd),
+     [w * (1 - 1e-2 * wd) - 1e-2 * g / (abs(g) + 1e-8) for w, g in zip(w0, g0)]),
+)
+for make, expected in cases:
+    w = smol_torch.Tensor(data=w0, shape=[4], dtype="float64")
+    opt = make([w])
+    opt.step([smol_torch.Tensor(data=g0, shape=[4], dtype="float64")])
+    assert opt.steps == 1
+    assert all(math.isclose(w[i], expected[i], rel_tol=1e-12, abs_tol=1e-15) for i in range(4)), type(opt).__name__
+print("optim ok")